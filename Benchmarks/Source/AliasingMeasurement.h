@@ -0,0 +1,164 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+struct AliasingResult
+{
+    juce::String module;
+    juce::String antiAliasing;
+    double frequency = 0.0;
+    double aliasDb = 0.0;
+};
+
+/**
+    How much of each clipper's output is aliasing, with and without
+    antiderivative anti-aliasing.
+
+    A 0.9 peak sine at each test frequency goes through Distortion<float> with
+    18 dB of drive. The output is Blackman windowed and transformed. Every bin
+    within a few bins of DC or a harmonic of the sine counts as signal, the rest
+    as aliasing. aliasDb is the aliasing energy relative to the total. Lower is
+    better. Both orders of anti-aliasing have to come out lower than none for
+    the same clipper at every frequency, and --aliasing fails otherwise. Second
+    order isn't always below first: close to Nyquist it can come out higher.
+*/
+class AliasingMeasurement
+{
+public:
+
+    /** Below this a clipper hardly aliases, and anti-aliasing only has to keep it there */
+    static constexpr double floorDb = -70.0;
+
+    explicit AliasingMeasurement(double sampleRateToUse)
+    : sampleRate(sampleRateToUse)
+    {
+    }
+
+    std::vector<AliasingResult> run() const
+    {
+        using Distortion = viator_dsp::Distortion<float>;
+
+        const std::pair<const char*, Distortion::ClipType> clipTypes[] = {
+            {"Distortion/Hard", Distortion::ClipType::kHard},
+            {"Distortion/Soft", Distortion::ClipType::kSoft},
+            {"Distortion/Tube", Distortion::ClipType::kTube},
+            {"Distortion/Saturation", Distortion::ClipType::kSaturation}
+        };
+
+        const std::pair<const char*, Distortion::AntiAliasing> orders[] = {
+            {"none", Distortion::AntiAliasing::kNone},
+            {"firstOrder", Distortion::AntiAliasing::kFirstOrder},
+            {"secondOrder", Distortion::AntiAliasing::kSecondOrder}
+        };
+
+        std::vector<AliasingResult> results;
+
+        for (const auto& clipType : clipTypes)
+        {
+            for (const auto& order : orders)
+            {
+                // Octave steps up to where the first harmonics already fold. 433 Hz doesn't divide
+                // common sample rates, so aliases land between the harmonics instead of on them.
+                for (auto frequency = 433.0; frequency < sampleRate * 0.3; frequency *= 2.0)
+                {
+                    AliasingResult result;
+                    result.module = clipType.first;
+                    result.antiAliasing = order.first;
+                    result.frequency = frequency;
+                    result.aliasDb = measure(clipType.second, order.second, frequency);
+                    results.push_back(result);
+
+                    std::cerr << result.module << " " << result.antiAliasing << " " << juce::String(frequency, 0)
+                              << " Hz: " << juce::String(result.aliasDb, 1) << " dB aliasing" << std::endl;
+                }
+            }
+        }
+
+        return results;
+    }
+
+    static bool antiAliasingHelps(const std::vector<AliasingResult>& results)
+    {
+        return std::all_of(results.begin(), results.end(), [&results](const AliasingResult& result)
+        {
+            if (result.antiAliasing == "none")
+            {
+                return true;
+            }
+
+            const auto none = std::find_if(results.begin(), results.end(), [&result](const AliasingResult& other)
+            {
+                return other.antiAliasing == "none" && other.module == result.module && other.frequency == result.frequency;
+            });
+
+            jassert(none != results.end());
+
+            return result.aliasDb < none->aliasDb || juce::jmax(result.aliasDb, none->aliasDb) < floorDb;
+        });
+    }
+
+private:
+
+    static constexpr int fftOrder = 16;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int blockSize = 512;
+
+    double measure(viator_dsp::Distortion<float>::ClipType clipType, viator_dsp::Distortion<float>::AntiAliasing antiAliasing, double frequency) const
+    {
+        viator_dsp::Distortion<float> distortion;
+        distortion.prepare({sampleRate, static_cast<juce::uint32>(blockSize), 1});
+        distortion.setClipperType(clipType);
+        distortion.setAntiAliasing(antiAliasing);
+        distortion.setDrive(18.0f);
+        distortion.setThresh(0.5f);
+
+        // Room for the transform's in-place output, after enough blocks for the smoothers to settle
+        std::vector<float> output(fftSize * 2, 0.0f);
+        std::array<float, blockSize> block;
+        const auto numWarmUpSamples = juce::roundToInt(sampleRate * 0.1);
+        const auto phaseIncrement = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+        for (int start = -numWarmUpSamples; start < fftSize; start += blockSize)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                block[static_cast<size_t>(i)] = static_cast<float>(0.9 * std::sin(phaseIncrement * (start + i)));
+            }
+
+            auto* channels = block.data();
+            juce::dsp::AudioBlock<float> audioBlock(&channels, 1, blockSize);
+            distortion.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+
+            for (int i = juce::jmax(0, -start); i < blockSize && start + i < fftSize; ++i)
+            {
+                output[static_cast<size_t>(start + i)] = block[static_cast<size_t>(i)];
+            }
+        }
+
+        juce::dsp::WindowingFunction<float> window(fftSize, juce::dsp::WindowingFunction<float>::blackman, false);
+        window.multiplyWithWindowingTable(output.data(), fftSize);
+
+        juce::dsp::FFT fft(fftOrder);
+        fft.performFrequencyOnlyForwardTransform(output.data(), true);
+
+        // The window spreads each line over a few bins either side
+        const auto binWidth = sampleRate / fftSize;
+        const auto guardBins = 8;
+        auto signalEnergy = 0.0;
+        auto aliasEnergy = 0.0;
+
+        for (int bin = 0; bin <= fftSize / 2; ++bin)
+        {
+            const auto energy = static_cast<double>(output[static_cast<size_t>(bin)]) * output[static_cast<size_t>(bin)];
+            const auto binFrequency = bin * binWidth;
+            const auto nearestHarmonic = juce::jmax(1.0, std::round(binFrequency / frequency)) * frequency;
+            const auto isSignal = bin <= guardBins || std::abs(binFrequency - nearestHarmonic) <= guardBins * binWidth;
+
+            (isSignal ? signalEnergy : aliasEnergy) += energy;
+        }
+
+        return 10.0 * std::log10(juce::jmax(1.0e-30, aliasEnergy / (signalEnergy + aliasEnergy)));
+    }
+
+    double sampleRate;
+};
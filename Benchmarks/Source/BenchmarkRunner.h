@@ -0,0 +1,257 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+/** One module configuration to time: how to set it up for a spec, and how to run it over a block in place. */
+template <typename SampleType>
+struct BenchmarkCase
+{
+    juce::String name;
+
+    /** 0 means any channel count */
+    int maxChannels = 0;
+
+    std::function<void(const juce::dsp::ProcessSpec&)> prepare;
+    std::function<void(juce::dsp::AudioBlock<SampleType>&)> process;
+
+    bool supportsChannels(int numChannels) const noexcept
+    {
+        return maxChannels == 0 || numChannels <= maxChannels;
+    }
+};
+
+/** Wraps a processor and two lambdas taking it into a case. The processor lives as long as the case does. */
+template <typename Processor, typename SampleType, typename Setup, typename Process>
+BenchmarkCase<SampleType> makeBenchmarkCase(const juce::String& name, Setup setup, Process process, int maxChannels = 0)
+{
+    auto processor = std::make_shared<Processor>();
+
+    BenchmarkCase<SampleType> benchmarkCase;
+    benchmarkCase.name = name;
+    benchmarkCase.maxChannels = maxChannels;
+    benchmarkCase.prepare = [processor, setup](const juce::dsp::ProcessSpec& spec) { setup(*processor, spec); };
+    benchmarkCase.process = [processor, process](juce::dsp::AudioBlock<SampleType>& block) { process(*processor, block); };
+    return benchmarkCase;
+}
+
+struct BenchmarkResult
+{
+    juce::String module;
+    juce::String sampleType;
+    int numChannels = 0;
+    int blockSize = 0;
+    double nsPerSample = 0.0;
+    double cyclesPerSample = 0.0;
+    juce::int64 samplesTimed = 0;
+};
+
+struct BenchmarkSettings
+{
+    double sampleRate = 48000.0;
+    int repetitions = 7;
+    double minimumBatchMs = 2.0;
+    juce::String filter;
+    std::vector<int> blockSizes {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    std::vector<int> channelCounts {1, 2, 8};
+};
+
+/**
+    Times BenchmarkCases over every block size and channel count in the settings.
+
+    Every block is refilled from the same noise before it is processed, so
+    recursive modules see a steady signal instead of their own output. The refill
+    is timed on its own with the same batch sizes and subtracted. Each
+    configuration runs repetitions batches of at least minimumBatchMs and keeps
+    the median. "Per sample" means per channel sample: a 2 channel, 512 sample
+    block counts as 1024 samples.
+
+    On x86 the cycle counts come from the time stamp counter, which ticks at the
+    nominal clock rather than the boosted one. Other platforms have no portable
+    user-mode cycle counter, so there the cycles are estimated from the reported
+    CPU clock.
+*/
+class BenchmarkRunner
+{
+public:
+
+    explicit BenchmarkRunner(const BenchmarkSettings& settingsToUse)
+    : settings(settingsToUse)
+    {
+    }
+
+    static bool hasCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    template <typename SampleType>
+    void run(std::vector<BenchmarkCase<SampleType>>& cases, const juce::String& sampleTypeName, std::vector<BenchmarkResult>& results)
+    {
+        for (auto& benchmarkCase : cases)
+        {
+            if (settings.filter.isNotEmpty() && ! benchmarkCase.name.containsIgnoreCase(settings.filter))
+            {
+                continue;
+            }
+
+            for (auto numChannels : settings.channelCounts)
+            {
+                if (! benchmarkCase.supportsChannels(numChannels))
+                {
+                    continue;
+                }
+
+                for (auto blockSize : settings.blockSizes)
+                {
+                    auto result = measure(benchmarkCase, numChannels, blockSize);
+                    result.sampleType = sampleTypeName;
+                    results.push_back(result);
+
+                    std::cerr << result.module << " " << sampleTypeName << " " << numChannels << "ch " << blockSize
+                              << ": " << juce::String(result.nsPerSample, 3) << " ns/sample, "
+                              << juce::String(result.cyclesPerSample, 2) << " cycles/sample" << std::endl;
+                }
+            }
+        }
+    }
+
+private:
+
+    struct Timing
+    {
+        double ns = 0.0;
+        double cycles = 0.0;
+    };
+
+    static juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return static_cast<juce::uint64>(__rdtsc());
+       #else
+        return 0;
+       #endif
+    }
+
+    template <typename SampleType>
+    BenchmarkResult measure(BenchmarkCase<SampleType>& benchmarkCase, int numChannels, int blockSize)
+    {
+        benchmarkCase.prepare({settings.sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+
+        juce::HeapBlock<char> sourceData, workData;
+        juce::dsp::AudioBlock<SampleType> source(sourceData, static_cast<size_t>(numChannels), static_cast<size_t>(blockSize));
+        juce::dsp::AudioBlock<SampleType> work(workData, static_cast<size_t>(numChannels), static_cast<size_t>(blockSize));
+
+        // Fixed seed so every run and every module sees the same -6 dBFS noise
+        juce::Random random(0x5eed);
+
+        for (size_t channel = 0; channel < source.getNumChannels(); ++channel)
+        {
+            auto* data = source.getChannelPointer(channel);
+
+            for (size_t i = 0; i < source.getNumSamples(); ++i)
+            {
+                data[i] = static_cast<SampleType>(random.nextFloat() - 0.5f);
+            }
+        }
+
+        auto processBlock = [&]
+        {
+            work.copyFrom(source);
+            benchmarkCase.process(work);
+        };
+
+        auto refillBlock = [&]
+        {
+            work.copyFrom(source);
+        };
+
+        // Warm up caches, smoothers and branch predictors, then size the batch
+        for (int i = 0; i < 16; ++i)
+        {
+            processBlock();
+        }
+
+        const auto numBlocks = getBlocksPerBatch(processBlock);
+
+        std::vector<Timing> processTimings, refillTimings;
+
+        for (int repetition = 0; repetition < settings.repetitions; ++repetition)
+        {
+            processTimings.push_back(timeBatch(processBlock, numBlocks));
+            refillTimings.push_back(timeBatch(refillBlock, numBlocks));
+        }
+
+        const auto numSamples = static_cast<double>(numBlocks) * blockSize * numChannels;
+        const auto processTiming = getMedian(processTimings);
+        const auto refillTiming = getMedian(refillTimings);
+
+        BenchmarkResult result;
+        result.module = benchmarkCase.name;
+        result.numChannels = numChannels;
+        result.blockSize = blockSize;
+        result.samplesTimed = static_cast<juce::int64>(numSamples) * settings.repetitions;
+        result.nsPerSample = juce::jmax(0.0, processTiming.ns - refillTiming.ns) / numSamples;
+
+        if (hasCycleCounter())
+        {
+            result.cyclesPerSample = juce::jmax(0.0, processTiming.cycles - refillTiming.cycles) / numSamples;
+        }
+        else
+        {
+            result.cyclesPerSample = result.nsPerSample * juce::SystemStats::getCpuSpeedInMegahertz() * 0.001;
+        }
+
+        return result;
+    }
+
+    template <typename Function>
+    int getBlocksPerBatch(Function&& function) const
+    {
+        // Double the batch until it takes long enough for the timer to resolve
+        for (int numBlocks = 1;; numBlocks *= 2)
+        {
+            if (numBlocks >= (1 << 20) || timeBatch(function, numBlocks).ns >= settings.minimumBatchMs * 1.0e6)
+            {
+                return numBlocks;
+            }
+        }
+    }
+
+    template <typename Function>
+    static Timing timeBatch(Function&& function, int numBlocks)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const auto startCycles = readCycleCounter();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            function();
+        }
+
+        const auto endCycles = readCycleCounter();
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+
+        return {juce::Time::highResolutionTicksToSeconds(endTicks - startTicks) * 1.0e9,
+                static_cast<double>(endCycles - startCycles)};
+    }
+
+    static Timing getMedian(std::vector<Timing> timings)
+    {
+        std::sort(timings.begin(), timings.end(), [](const Timing& a, const Timing& b) { return a.ns < b.ns; });
+        return timings[timings.size() / 2];
+    }
+
+    BenchmarkSettings settings;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+struct CompressorAccuracyResult
+{
+    juce::String sampleType;
+    double threshold = 0.0;
+    double ratio = 1.0;
+    double attack = 0.0;
+    double maxErrorDb = 0.0;
+};
+
+/**
+    How far viator_dsp::Compressor's gain strays from juce::dsp::Compressor's.
+
+    Both compressors get the same settings and the same modulated noise plus
+    sine, block by block. The gain of each is its output over its input, taken
+    wherever the input is above -80 dB. maxErrorDb is the largest difference
+    between the two gains in dB, over every sample. Compressor.h promises at
+    most toleranceDb for every setting.
+*/
+class CompressorAccuracy
+{
+public:
+
+    static constexpr double toleranceDb = 0.001;
+
+    explicit CompressorAccuracy(double sampleRateToUse)
+    : sampleRate(sampleRateToUse)
+    {
+    }
+
+    std::vector<CompressorAccuracyResult> run() const
+    {
+        std::vector<CompressorAccuracyResult> results;
+        measureAll<float>("float", results);
+        measureAll<double>("double", results);
+        return results;
+    }
+
+    static bool withinTolerance(const std::vector<CompressorAccuracyResult>& results)
+    {
+        return std::all_of(results.begin(), results.end(), [](const CompressorAccuracyResult& result) { return result.maxErrorDb <= toleranceDb; });
+    }
+
+private:
+
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 200;
+
+    template <typename SampleType>
+    void measureAll(const char* sampleType, std::vector<CompressorAccuracyResult>& results) const
+    {
+        for (auto threshold : {-40.0, -24.0, -6.0, 0.0})
+        {
+            for (auto ratio : {1.5, 4.0, 20.0, 100.0})
+            {
+                for (auto attack : {0.1, 5.0, 50.0})
+                {
+                    CompressorAccuracyResult result;
+                    result.sampleType = sampleType;
+                    result.threshold = threshold;
+                    result.ratio = ratio;
+                    result.attack = attack;
+                    result.maxErrorDb = measure<SampleType>(threshold, ratio, attack);
+                    results.push_back(result);
+
+                    std::cerr << "Compressor<" << sampleType << "> " << threshold << " dB, " << ratio << ":1, " << attack
+                              << " ms attack: " << juce::String(result.maxErrorDb, 6) << " dB from juce::dsp::Compressor" << std::endl;
+                }
+            }
+        }
+    }
+
+    template <typename SampleType>
+    double measure(double threshold, double ratio, double attack) const
+    {
+        const juce::dsp::ProcessSpec spec {sampleRate, static_cast<juce::uint32>(blockSize), 1};
+
+        viator_dsp::Compressor<SampleType> compressor;
+        compressor.prepare(spec);
+        compressor.setThreshold(static_cast<SampleType>(threshold));
+        compressor.setRatio(static_cast<SampleType>(ratio));
+        compressor.setAttack(static_cast<SampleType>(attack));
+        compressor.setRelease(static_cast<SampleType>(100.0));
+
+        juce::dsp::Compressor<SampleType> reference;
+        reference.prepare(spec);
+        reference.setThreshold(static_cast<SampleType>(threshold));
+        reference.setRatio(static_cast<SampleType>(ratio));
+        reference.setAttack(static_cast<SampleType>(attack));
+        reference.setRelease(static_cast<SampleType>(100.0));
+
+        juce::Random random(5);
+        std::array<SampleType, blockSize> input, output, referenceOutput;
+        auto maxErrorDb = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Noise swelling in and out under a steady sine, so both sides of the threshold get crossed
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto n = static_cast<double>(block * blockSize + i);
+                const auto noise = 0.5 * (random.nextDouble() * 2.0 - 1.0) * (1.0 + std::sin(n * 0.0007));
+                input[static_cast<size_t>(i)] = static_cast<SampleType>(noise + 0.3 * std::sin(n * 0.05));
+            }
+
+            output = input;
+            referenceOutput = input;
+
+            auto* channel = output.data();
+            juce::dsp::AudioBlock<SampleType> audioBlock(&channel, 1, blockSize);
+            compressor.process(juce::dsp::ProcessContextReplacing<SampleType>(audioBlock));
+
+            auto* referenceChannel = referenceOutput.data();
+            juce::dsp::AudioBlock<SampleType> referenceBlock(&referenceChannel, 1, blockSize);
+            reference.process(juce::dsp::ProcessContextReplacing<SampleType>(referenceBlock));
+
+            for (size_t i = 0; i < input.size(); ++i)
+            {
+                const auto in = static_cast<double>(input[i]);
+
+                if (std::abs(in) > 1.0e-4)
+                {
+                    const auto gainDb = juce::Decibels::gainToDecibels(std::abs(static_cast<double>(output[i]) / in), -400.0);
+                    const auto referenceGainDb = juce::Decibels::gainToDecibels(std::abs(static_cast<double>(referenceOutput[i]) / in), -400.0);
+                    maxErrorDb = juce::jmax(maxErrorDb, std::abs(gainDb - referenceGainDb));
+                }
+            }
+        }
+
+        return maxErrorDb;
+    }
+
+    double sampleRate;
+};
@@ -0,0 +1,291 @@
+/*
+  ==============================================================================
+
+    Micro-benchmarks for the viator_dsp modules. Times every module for float
+    and double over a range of block sizes and channel counts, and writes the
+    results as JSON so runs can be compared between releases.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ModuleBenchmarks.h"
+#include "PluginBenchmarks.h"
+#include "AliasingMeasurement.h"
+#include "CompressorAccuracy.h"
+
+namespace
+{
+
+template <typename SampleType>
+std::vector<BenchmarkCase<SampleType>> createBenchmarks()
+{
+    auto cases = createModuleBenchmarks<SampleType>();
+
+    for (auto& pluginCase : createPluginBenchmarks<SampleType>())
+    {
+        cases.push_back(std::move(pluginCase));
+    }
+
+    return cases;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: Benchmarks [options]" << std::endl
+              << std::endl
+              << "  --output <file>       Write the JSON report here instead of to stdout" << std::endl
+              << "  --filter <text>       Only run modules whose name contains text, e.g. --filter SVFilter" << std::endl
+              << "  --repetitions <n>     Timed batches per configuration, the median is kept (default: 7)" << std::endl
+              << "  --min-batch-ms <ms>   Shortest timed batch (default: 2)" << std::endl
+              << "  --sample-rate <hz>    Sample rate the modules are prepared with (default: 48000)" << std::endl
+              << "  --channels <list>     Comma separated channel counts, up to 16 (default: 1,2,8)" << std::endl
+              << "  --float-only          Skip the double precision run" << std::endl
+              << "  --aliasing            Also measure the Distortion clippers' aliasing, failing where anti-aliasing doesn't lower it" << std::endl
+              << "  --accuracy            Also compare Compressor's gain with juce::dsp::Compressor's, failing above 0.001 dB" << std::endl
+              << std::endl
+              << "Progress goes to stderr, so stdout can be redirected straight to a file." << std::endl;
+}
+
+bool parseArguments(const juce::StringArray& arguments, BenchmarkSettings& settings, juce::File& outputFile, bool& floatOnly, bool& measureAliasing, bool& measureAccuracy)
+{
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        const auto& argument = arguments[i];
+        const auto hasValue = i + 1 < arguments.size();
+
+        if (argument == "--output" && hasValue)
+        {
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments[++i]);
+        }
+        else if (argument == "--filter" && hasValue)
+        {
+            settings.filter = arguments[++i];
+        }
+        else if (argument == "--repetitions" && hasValue)
+        {
+            settings.repetitions = arguments[++i].getIntValue();
+        }
+        else if (argument == "--min-batch-ms" && hasValue)
+        {
+            settings.minimumBatchMs = arguments[++i].getDoubleValue();
+        }
+        else if (argument == "--sample-rate" && hasValue)
+        {
+            settings.sampleRate = arguments[++i].getDoubleValue();
+        }
+        else if (argument == "--channels" && hasValue)
+        {
+            settings.channelCounts.clear();
+
+            for (const auto& count : juce::StringArray::fromTokens(arguments[++i], ",", {}))
+            {
+                settings.channelCounts.push_back(count.getIntValue());
+            }
+        }
+        else if (argument == "--float-only")
+        {
+            floatOnly = true;
+        }
+        else if (argument == "--aliasing")
+        {
+            measureAliasing = true;
+        }
+        else if (argument == "--accuracy")
+        {
+            measureAccuracy = true;
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << argument << std::endl;
+            return false;
+        }
+    }
+
+    if (settings.repetitions <= 0 || settings.minimumBatchMs <= 0.0 || settings.sampleRate <= 0.0)
+    {
+        std::cerr << "--repetitions, --min-batch-ms and --sample-rate must be positive" << std::endl;
+        return false;
+    }
+
+    for (auto numChannels : settings.channelCounts)
+    {
+        if (numChannels < 1 || numChannels > 16)
+        {
+            std::cerr << "--channels takes counts from 1 to 16" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+juce::var createReport(const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results, const std::vector<AliasingResult>& aliasingResults,
+                       const std::vector<CompressorAccuracyResult>& accuracyResults)
+{
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("cpuMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+    machine->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty("simdFloatLanes", static_cast<int>(juce::dsp::SIMDRegister<float>::size()));
+    machine->setProperty("cycleSource", BenchmarkRunner::hasCycleCounter() ? "tsc" : "estimated");
+
+    auto* build = new juce::DynamicObject();
+    build->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    build->setProperty("debug", JUCE_DEBUG != 0);
+    build->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+
+    auto* config = new juce::DynamicObject();
+    config->setProperty("sampleRate", settings.sampleRate);
+    config->setProperty("repetitions", settings.repetitions);
+    config->setProperty("minBatchMs", settings.minimumBatchMs);
+
+    juce::Array<juce::var> entries;
+
+    for (const auto& result : results)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("module", result.module);
+        entry->setProperty("sampleType", result.sampleType);
+        entry->setProperty("channels", result.numChannels);
+        entry->setProperty("blockSize", result.blockSize);
+        entry->setProperty("nsPerSample", result.nsPerSample);
+        entry->setProperty("cyclesPerSample", result.cyclesPerSample);
+        entry->setProperty("samplesTimed", result.samplesTimed);
+        entries.add(juce::var(entry));
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("machine", juce::var(machine));
+    report->setProperty("build", juce::var(build));
+    report->setProperty("config", juce::var(config));
+    report->setProperty("results", entries);
+
+    if (! aliasingResults.empty())
+    {
+        juce::Array<juce::var> aliasingEntries;
+
+        for (const auto& result : aliasingResults)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("module", result.module);
+            entry->setProperty("antiAliasing", result.antiAliasing);
+            entry->setProperty("frequency", result.frequency);
+            entry->setProperty("aliasDb", result.aliasDb);
+            aliasingEntries.add(juce::var(entry));
+        }
+
+        report->setProperty("aliasing", aliasingEntries);
+    }
+
+    if (! accuracyResults.empty())
+    {
+        juce::Array<juce::var> accuracyEntries;
+
+        for (const auto& result : accuracyResults)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("sampleType", result.sampleType);
+            entry->setProperty("threshold", result.threshold);
+            entry->setProperty("ratio", result.ratio);
+            entry->setProperty("attack", result.attack);
+            entry->setProperty("maxErrorDb", result.maxErrorDb);
+            accuracyEntries.add(juce::var(entry));
+        }
+
+        report->setProperty("compressorAccuracy", accuracyEntries);
+    }
+
+    return juce::var(report);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+    }
+
+    BenchmarkSettings settings;
+    juce::File outputFile;
+    auto floatOnly = false;
+    auto measureAliasing = false;
+    auto measureAccuracy = false;
+
+    if (! parseArguments(arguments, settings, outputFile, floatOnly, measureAliasing, measureAccuracy))
+    {
+        printUsage();
+        return 1;
+    }
+
+   #if JUCE_DEBUG
+    std::cerr << "Warning: this is a debug build, the numbers will not mean much" << std::endl;
+   #endif
+
+    BenchmarkRunner runner(settings);
+    std::vector<BenchmarkResult> results;
+
+    {
+        auto cases = createBenchmarks<float>();
+        runner.run(cases, "float", results);
+    }
+
+    if (! floatOnly)
+    {
+        auto cases = createBenchmarks<double>();
+        runner.run(cases, "double", results);
+    }
+
+    std::vector<AliasingResult> aliasingResults;
+
+    if (measureAliasing)
+    {
+        aliasingResults = AliasingMeasurement(settings.sampleRate).run();
+    }
+
+    std::vector<CompressorAccuracyResult> accuracyResults;
+
+    if (measureAccuracy)
+    {
+        accuracyResults = CompressorAccuracy(settings.sampleRate).run();
+    }
+
+    const auto json = juce::JSON::toString(createReport(settings, results, aliasingResults, accuracyResults));
+
+    // The report is still written, so the failing settings can be looked up
+    auto exitCode = 0;
+
+    if (! CompressorAccuracy::withinTolerance(accuracyResults))
+    {
+        std::cerr << "Compressor strays more than " << CompressorAccuracy::toleranceDb << " dB from juce::dsp::Compressor" << std::endl;
+        exitCode = 1;
+    }
+
+    if (! AliasingMeasurement::antiAliasingHelps(aliasingResults))
+    {
+        std::cerr << "Anti-aliasing doesn't lower a Distortion clipper's aliasing at every frequency" << std::endl;
+        exitCode = 1;
+    }
+
+    if (outputFile == juce::File())
+    {
+        std::cout << json << std::endl;
+        return exitCode;
+    }
+
+    if (! outputFile.replaceWithText(json))
+    {
+        std::cerr << "Cannot write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,696 @@
+#pragma once
+
+#include "BenchmarkRunner.h"
+
+/**
+    The viator_dsp configurations the benchmark times. Each case calls the path the
+    plugins use: process() where the module has one, otherwise processSample() or
+    processBuffer() over the block.
+
+    Some modules only exist for float (BrickWallLPF, LFOGenerator, BitCrusher's
+    processBuffer) and BrickWallLPF packs at most one SIMD register of channels,
+    so those cases are left out of the double run or the wider channel counts.
+*/
+template <typename SampleType>
+std::vector<BenchmarkCase<SampleType>> createModuleBenchmarks()
+{
+    using Block = juce::dsp::AudioBlock<SampleType>;
+    using Spec = juce::dsp::ProcessSpec;
+    using Context = juce::dsp::ProcessContextReplacing<SampleType>;
+
+    constexpr auto isFloat = std::is_same<SampleType, float>::value;
+
+    std::vector<BenchmarkCase<SampleType>> cases;
+
+    //==============================================================================
+    using Distortion = viator_dsp::Distortion<SampleType>;
+
+    const std::pair<const char*, typename Distortion::ClipType> clipTypes[] = {
+        {"Distortion/Hard", Distortion::ClipType::kHard},
+        {"Distortion/Soft", Distortion::ClipType::kSoft},
+        {"Distortion/Fuzz", Distortion::ClipType::kFuzz},
+        {"Distortion/Tube", Distortion::ClipType::kTube},
+        {"Distortion/Saturation", Distortion::ClipType::kSaturation},
+        {"Distortion/Lofi", Distortion::ClipType::kLofi}
+    };
+
+    for (const auto& clipType : clipTypes)
+    {
+        const auto type = clipType.second;
+
+        cases.push_back(makeBenchmarkCase<Distortion, SampleType>(clipType.first,
+            [type](Distortion& distortion, const Spec& spec)
+            {
+                distortion.prepare(spec);
+                distortion.setClipperType(type);
+                distortion.setDrive(12.0);
+                distortion.setThresh(0.5);
+            },
+            [](Distortion& distortion, Block& block) { distortion.process(Context(block)); }));
+    }
+
+    // What each order of antiderivative anti-aliasing adds to the plain kernels above
+    const std::pair<const char*, typename Distortion::AntiAliasing> antiAliasingOrders[] = {
+        {"ADAA1", Distortion::AntiAliasing::kFirstOrder},
+        {"ADAA2", Distortion::AntiAliasing::kSecondOrder}
+    };
+
+    for (const auto& clipType : {clipTypes[0], clipTypes[1], clipTypes[3], clipTypes[4]})
+    {
+        for (const auto& order : antiAliasingOrders)
+        {
+            const auto type = clipType.second;
+            const auto antiAliasing = order.second;
+
+            cases.push_back(makeBenchmarkCase<Distortion, SampleType>(juce::String(clipType.first) + order.first,
+                [type, antiAliasing](Distortion& distortion, const Spec& spec)
+                {
+                    distortion.prepare(spec);
+                    distortion.setClipperType(type);
+                    distortion.setAntiAliasing(antiAliasing);
+                    distortion.setDrive(12.0);
+                    distortion.setThresh(0.5);
+                },
+                [](Distortion& distortion, Block& block) { distortion.process(Context(block)); }));
+        }
+    }
+
+    // The per-sample switch process() used to run, as the baseline for the block kernels
+    for (const auto& clipType : {clipTypes[0], clipTypes[1]})
+    {
+        const auto type = clipType.second;
+
+        cases.push_back(makeBenchmarkCase<Distortion, SampleType>(juce::String(clipType.first) + "PerSample",
+            [type](Distortion& distortion, const Spec& spec)
+            {
+                distortion.prepare(spec);
+                distortion.setClipperType(type);
+                distortion.setDrive(12.0);
+            },
+            [](Distortion& distortion, Block& block)
+            {
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    auto* data = block.getChannelPointer(channel);
+
+                    for (size_t i = 0; i < block.getNumSamples(); ++i)
+                    {
+                        data[i] = distortion.processSample(data[i], static_cast<int>(channel));
+                    }
+                }
+            }));
+    }
+
+    //==============================================================================
+    using SVFilter = viator_dsp::SVFilter<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<SVFilter, SampleType>("SVFilter/LowPass",
+        [](SVFilter& filter, const Spec& spec)
+        {
+            filter.prepare(spec);
+            filter.setParameter(SVFilter::ParameterId::kType, SVFilter::FilterType::kLowPass);
+            filter.setParameter(SVFilter::ParameterId::kCutoff, 1000.0);
+            filter.setParameter(SVFilter::ParameterId::kQ, 0.3);
+        },
+        [](SVFilter& filter, Block& block) { filter.process(Context(block)); }));
+
+    cases.push_back(makeBenchmarkCase<SVFilter, SampleType>("SVFilter/BandShelf",
+        [](SVFilter& filter, const Spec& spec)
+        {
+            filter.prepare(spec);
+            filter.setParameter(SVFilter::ParameterId::kType, SVFilter::FilterType::kBandShelf);
+            filter.setParameter(SVFilter::ParameterId::kCutoff, 1000.0);
+            filter.setParameter(SVFilter::ParameterId::kQ, 0.3);
+            filter.setParameter(SVFilter::ParameterId::kGain, 6.0);
+        },
+        [](SVFilter& filter, Block& block) { filter.process(Context(block)); }));
+
+    // At 2 channels this should cost one mono SVFilter/LowPass pass plus the mid/side matrix
+    cases.push_back(makeBenchmarkCase<SVFilter, SampleType>("SVFilter/LowPassMid",
+        [](SVFilter& filter, const Spec& spec)
+        {
+            filter.prepare(spec);
+            filter.setStereoType(SVFilter::StereoId::kMids);
+            filter.setParameter(SVFilter::ParameterId::kType, SVFilter::FilterType::kLowPass);
+            filter.setParameter(SVFilter::ParameterId::kCutoff, 1000.0);
+            filter.setParameter(SVFilter::ParameterId::kQ, 0.3);
+        },
+        [](SVFilter& filter, Block& block) { filter.process(Context(block)); },
+        2));
+
+    // A two octave sweep each block, through processModulated()'s interpolated coefficients
+    struct ModulatedSVFilter
+    {
+        SVFilter filter;
+        std::vector<SampleType> cutoffs;
+    };
+
+    cases.push_back(makeBenchmarkCase<ModulatedSVFilter, SampleType>("SVFilter/LowPassModulated",
+        [](ModulatedSVFilter& modulated, const Spec& spec)
+        {
+            modulated.filter.prepare(spec);
+            modulated.filter.setParameter(SVFilter::ParameterId::kType, SVFilter::FilterType::kLowPass);
+            modulated.filter.setParameter(SVFilter::ParameterId::kQ, 0.3);
+
+            modulated.cutoffs.resize(spec.maximumBlockSize);
+
+            for (size_t i = 0; i < modulated.cutoffs.size(); ++i)
+            {
+                modulated.cutoffs[i] = static_cast<SampleType>(500.0 * std::exp2(2.0 * static_cast<double>(i) / static_cast<double>(modulated.cutoffs.size())));
+            }
+        },
+        [](ModulatedSVFilter& modulated, Block& block) { modulated.filter.processModulated(Context(block), modulated.cutoffs.data()); }));
+
+    //==============================================================================
+    // The same 8 band EQ as eight chained SVFilters and as one SVFilterBank
+    constexpr int numEQBands = 8;
+
+    cases.push_back(makeBenchmarkCase<std::array<SVFilter, numEQBands>, SampleType>("SVFilter/8BandChain",
+        [](std::array<SVFilter, numEQBands>& filters, const Spec& spec)
+        {
+            for (size_t band = 0; band < filters.size(); ++band)
+            {
+                filters[band].prepare(spec);
+                filters[band].setParameter(SVFilter::ParameterId::kType, SVFilter::FilterType::kBandShelf);
+                filters[band].setParameter(SVFilter::ParameterId::kQ, 0.3);
+                filters[band].setParameter(SVFilter::ParameterId::kCutoff, 50.0 * static_cast<double>(2 << band));
+                filters[band].setParameter(SVFilter::ParameterId::kGain, band % 2 == 0 ? 3.0 : -3.0);
+            }
+        },
+        [](std::array<SVFilter, numEQBands>& filters, Block& block)
+        {
+            for (auto& filter : filters)
+            {
+                filter.process(Context(block));
+            }
+        }));
+
+    using SVFilterBank = viator_dsp::SVFilterBank<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<SVFilterBank, SampleType>("SVFilterBank/8Band",
+        [](SVFilterBank& bank, const Spec& spec)
+        {
+            bank.prepare(spec);
+
+            for (int band = 0; band < numEQBands; ++band)
+            {
+                bank.setBand(band, SVFilterBank::FilterType::kBandShelf, static_cast<SampleType>(50 * (2 << band)), static_cast<SampleType>(0.3), band % 2 == 0 ? 3 : -3);
+                bank.setBandEnabled(band, true);
+            }
+        },
+        [](SVFilterBank& bank, Block& block) { bank.process(Context(block)); }));
+
+    //==============================================================================
+    using DynamicEQ = viator_dsp::DynamicEQ<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<DynamicEQ, SampleType>("DynamicEQ/4Band",
+        [](DynamicEQ& eq, const Spec& spec)
+        {
+            eq.prepare(spec);
+
+            // Thresholds low enough that every band is moving
+            for (int band = 0; band < DynamicEQ::maxBands; ++band)
+            {
+                eq.setBandType(band, band == 0 ? DynamicEQ::BandType::kLowShelf
+                                   : band == DynamicEQ::maxBands - 1 ? DynamicEQ::BandType::kHighShelf
+                                                                    : DynamicEQ::BandType::kBell);
+                eq.setFrequency(band, static_cast<SampleType>(100 * (5 << band)));
+                eq.setThreshold(band, -40);
+                eq.setRange(band, band % 2 == 0 ? -6 : 6);
+            }
+        },
+        [](DynamicEQ& eq, Block& block) { eq.process(Context(block)); }));
+
+    //==============================================================================
+    using Tube = viator_dsp::Tube<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<Tube, SampleType>("Tube",
+        [](Tube& tube, const Spec& spec)
+        {
+            tube.prepare(spec);
+            tube.setDrive(12.0);
+            tube.setMix(1.0);
+        },
+        [](Tube& tube, Block& block) { tube.process(Context(block)); }));
+
+    //==============================================================================
+    using Expander = viator_dsp::Expander<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<Expander, SampleType>("Expander",
+        [](Expander& expander, const Spec& spec)
+        {
+            expander.prepare(spec);
+            expander.setThreshold(-30.0);
+            expander.setRatio(4.0);
+            expander.setAttack(1.0);
+            expander.setRelease(100.0);
+        },
+        [](Expander& expander, Block& block) { expander.process(Context(block)); }));
+
+    // A drum gate: the hold bridges the noise's dips, so the gate settles open
+    const std::pair<const char*, double> gateVariants[] = {
+        {"Expander/Gate", 0.0},
+        {"Expander/GateLookahead", 2.0}
+    };
+
+    for (const auto& variant : gateVariants)
+    {
+        const auto lookaheadMs = variant.second;
+
+        cases.push_back(makeBenchmarkCase<Expander, SampleType>(variant.first,
+            [lookaheadMs](Expander& expander, const Spec& spec)
+            {
+                expander.prepare(spec);
+                expander.setThreshold(-30.0);
+                expander.setRatio(20.0);
+                expander.setHysteresis(6.0);
+                expander.setHold(20.0);
+                expander.setRange(-60.0);
+                expander.setAttack(0.5);
+                expander.setRelease(100.0);
+                expander.setLookahead(lookaheadMs);
+            },
+            [](Expander& expander, Block& block) { expander.process(Context(block)); }));
+    }
+
+    // The same gate on a busy kit: the noise under 16th note hits at 120 bpm, each at its own level
+    // and decaying onto bleed 50 dB down, so the gate keeps opening and closing instead of settling.
+    // Walking the envelope adds one vector multiply per sample.
+    struct DrumGate
+    {
+        Expander expander;
+        std::vector<SampleType> envelope;
+        size_t position = 0;
+    };
+
+    cases.push_back(makeBenchmarkCase<DrumGate, SampleType>("Expander/GateDrums",
+        [](DrumGate& drums, const Spec& spec)
+        {
+            drums.expander.prepare(spec);
+            drums.expander.setThreshold(-30.0);
+            drums.expander.setRatio(20.0);
+            drums.expander.setHysteresis(6.0);
+            drums.expander.setHold(20.0);
+            drums.expander.setRange(-60.0);
+            drums.expander.setAttack(0.5);
+            drums.expander.setRelease(100.0);
+
+            // Two bars of hits, each decaying with a 20 ms time constant
+            constexpr size_t numHits = 32;
+            const auto hitLength = static_cast<size_t>(spec.sampleRate / 8.0);
+            juce::Random random(0xd2u);
+
+            drums.envelope.resize(numHits * hitLength);
+            drums.position = 0;
+
+            for (size_t hit = 0; hit < numHits; ++hit)
+            {
+                const auto level = 0.1 + 0.9 * random.nextDouble();
+
+                for (size_t i = 0; i < hitLength; ++i)
+                {
+                    const auto decay = level * std::exp(-static_cast<double>(i) / (0.02 * spec.sampleRate));
+                    drums.envelope[hit * hitLength + i] = static_cast<SampleType>(juce::jmax(0.003, decay));
+                }
+            }
+        },
+        [](DrumGate& drums, Block& block)
+        {
+            // The runner refills the same noise every block, so the envelope carries on from the last one
+            const auto numSamples = block.getNumSamples();
+
+            for (size_t start = 0; start < numSamples;)
+            {
+                const auto length = juce::jmin(numSamples - start, drums.envelope.size() - drums.position);
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    juce::FloatVectorOperations::multiply(block.getChannelPointer(channel) + start, drums.envelope.data() + drums.position, static_cast<int>(length));
+                }
+
+                drums.position = (drums.position + length) % drums.envelope.size();
+                start += length;
+            }
+
+            drums.expander.process(Context(block));
+        }));
+
+    //==============================================================================
+    using Compressor = viator_dsp::Compressor<SampleType>;
+
+    const std::tuple<const char*, double, typename Compressor::LinkMode> compressorVariants[] = {
+        {"Compressor", 0.0, Compressor::LinkMode::kUnlinked},
+        {"Compressor/Lookahead", 5.0, Compressor::LinkMode::kUnlinked},
+        {"Compressor/MaxLinked", 0.0, Compressor::LinkMode::kMaxLinked},
+        {"Compressor/AverageLinked", 0.0, Compressor::LinkMode::kAverageLinked},
+        {"Compressor/MidSide", 0.0, Compressor::LinkMode::kMidSide}
+    };
+
+    for (const auto& variant : compressorVariants)
+    {
+        const auto lookaheadMs = std::get<1>(variant);
+        const auto linkMode = std::get<2>(variant);
+
+        cases.push_back(makeBenchmarkCase<Compressor, SampleType>(std::get<0>(variant),
+            [lookaheadMs, linkMode](Compressor& compressor, const Spec& spec)
+            {
+                compressor.prepare(spec);
+                compressor.setThreshold(-24.0);
+                compressor.setRatio(4.0);
+                compressor.setAttack(5.0);
+                compressor.setRelease(100.0);
+                compressor.setLookahead(static_cast<SampleType>(lookaheadMs));
+                compressor.setLinkMode(linkMode);
+            },
+            [](Compressor& compressor, Block& block) { compressor.process(Context(block)); }));
+    }
+
+    //==============================================================================
+    // The same expander plus compressor as two chained stages and as one DynamicsProcessor
+    struct ExpanderCompressorChain
+    {
+        Expander expander;
+        Compressor compressor;
+    };
+
+    cases.push_back(makeBenchmarkCase<ExpanderCompressorChain, SampleType>("Expander+Compressor",
+        [](ExpanderCompressorChain& chain, const Spec& spec)
+        {
+            chain.expander.prepare(spec);
+            chain.expander.setThreshold(-50.0);
+            chain.expander.setRatio(3.0);
+            chain.expander.setRange(-60.0);
+            chain.expander.setAttack(5.0);
+            chain.expander.setRelease(100.0);
+
+            chain.compressor.prepare(spec);
+            chain.compressor.setThreshold(-24.0);
+            chain.compressor.setRatio(4.0);
+            chain.compressor.setAttack(5.0);
+            chain.compressor.setRelease(100.0);
+        },
+        [](ExpanderCompressorChain& chain, Block& block)
+        {
+            chain.expander.process(Context(block));
+            chain.compressor.process(Context(block));
+        }));
+
+    using DynamicsProcessor = viator_dsp::DynamicsProcessor<SampleType>;
+
+    const std::pair<const char*, typename DynamicsProcessor::LinkMode> dynamicsVariants[] = {
+        {"DynamicsProcessor", DynamicsProcessor::LinkMode::kUnlinked},
+        {"DynamicsProcessor/MaxLinked", DynamicsProcessor::LinkMode::kMaxLinked}
+    };
+
+    for (const auto& variant : dynamicsVariants)
+    {
+        const auto linkMode = variant.second;
+
+        cases.push_back(makeBenchmarkCase<DynamicsProcessor, SampleType>(variant.first,
+            [linkMode](DynamicsProcessor& dynamics, const Spec& spec)
+            {
+                dynamics.prepare(spec);
+                dynamics.setLowerThreshold(-50.0);
+                dynamics.setExpansionRatio(3.0);
+                dynamics.setLowerKnee(6.0);
+                dynamics.setRange(-60.0);
+                dynamics.setUpperThreshold(-24.0);
+                dynamics.setCompressionRatio(4.0);
+                dynamics.setUpperKnee(6.0);
+                dynamics.setAttack(5.0);
+                dynamics.setRelease(100.0);
+                dynamics.setLinkMode(linkMode);
+            },
+            [](DynamicsProcessor& dynamics, Block& block) { dynamics.process(Context(block)); }));
+    }
+
+    //==============================================================================
+    using LookaheadDelay = viator_dsp::LookaheadDelay<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<LookaheadDelay, SampleType>("LookaheadDelay/PeakHold",
+        [](LookaheadDelay& delay, const Spec& spec)
+        {
+            delay.prepare(spec, 1024);
+            delay.setDelay(240);
+        },
+        [](LookaheadDelay& delay, Block& block)
+        {
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* data = block.getChannelPointer(channel);
+                delay.processPeakHold(static_cast<int>(channel), data, static_cast<int>(block.getNumSamples()));
+                delay.processDelay(static_cast<int>(channel), data, static_cast<int>(block.getNumSamples()));
+            }
+        }));
+
+    //==============================================================================
+    using LevelAnalyser = viator_dsp::LevelAnalyser<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<std::vector<viator_dsp::BlockLevels<SampleType>>, SampleType>("LevelAnalyser",
+        [](std::vector<viator_dsp::BlockLevels<SampleType>>& levels, const Spec& spec) { levels.resize(spec.numChannels); },
+        [](std::vector<viator_dsp::BlockLevels<SampleType>>& levels, Block& block)
+        {
+            LevelAnalyser::analyse(juce::dsp::AudioBlock<const SampleType>(block), levels.data());
+        }));
+
+    //==============================================================================
+    using BitCrusher = viator_dsp::BitCrusher<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<BitCrusher, SampleType>("BitCrusher/processSample",
+        [](BitCrusher& crusher, const Spec& spec)
+        {
+            crusher.prepare(spec);
+            crusher.setBitDepth(8.0);
+        },
+        [](BitCrusher& crusher, Block& block)
+        {
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* data = block.getChannelPointer(channel);
+
+                for (size_t i = 0; i < block.getNumSamples(); ++i)
+                {
+                    data[i] = crusher.processSample(data[i], static_cast<int>(channel), static_cast<int>(i));
+                }
+            }
+        }));
+
+    //==============================================================================
+    using MultiBandProcessor = viator_dsp::MultiBandProcessor<SampleType>;
+
+    cases.push_back(makeBenchmarkCase<MultiBandProcessor, SampleType>("MultiBandProcessor/processSample",
+        [](MultiBandProcessor& multiBand, const Spec& spec) { multiBand.prepare(spec); },
+        [](MultiBandProcessor& multiBand, Block& block)
+        {
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* data = block.getChannelPointer(channel);
+
+                for (size_t i = 0; i < block.getNumSamples(); ++i)
+                {
+                    multiBand.processSample(data[i], static_cast<int>(channel));
+                    data[i] = multiBand.getLowBand() + multiBand.getLowMidBand() + multiBand.getMidBand() + multiBand.getHighBand();
+                }
+            }
+        }));
+
+    for (int numBands : {2, 4, 8})
+    {
+        cases.push_back(makeBenchmarkCase<MultiBandProcessor, SampleType>("MultiBandProcessor/" + juce::String(numBands) + "Band",
+            [numBands](MultiBandProcessor& multiBand, const Spec& spec)
+            {
+                multiBand.prepare(spec);
+                multiBand.setNumBands(numBands);
+            },
+            [](MultiBandProcessor& multiBand, Block& block)
+            {
+                multiBand.process(block);
+                block.copyFrom(multiBand.getBand(0));
+
+                for (int band = 1; band < multiBand.getNumBands(); ++band)
+                {
+                    block.add(multiBand.getBand(band));
+                }
+            }));
+    }
+
+    // Against 4Band: the convolution at the smallest and default partition sizes
+    for (int partitionSize : {64, 256})
+    {
+        cases.push_back(makeBenchmarkCase<MultiBandProcessor, SampleType>("MultiBandProcessor/4BandLinearPhase" + juce::String(partitionSize),
+            [partitionSize](MultiBandProcessor& multiBand, const Spec& spec)
+            {
+                multiBand.prepare(spec);
+                multiBand.setNumBands(4);
+                multiBand.setCrossoverMode(MultiBandProcessor::CrossoverMode::kLinearPhase);
+                multiBand.setPartitionSize(partitionSize);
+            },
+            [](MultiBandProcessor& multiBand, Block& block)
+            {
+                multiBand.process(block);
+                block.copyFrom(multiBand.getBand(0));
+
+                for (int band = 1; band < multiBand.getNumBands(); ++band)
+                {
+                    block.add(multiBand.getBand(band));
+                }
+            }));
+    }
+
+    //==============================================================================
+    if constexpr (isFloat)
+    {
+        // Channel-major clipping followed by a block pass of the DC filter
+        cases.push_back(makeBenchmarkCase<viator_dsp::Distortion<float>, float>("Distortion/processBuffer",
+            [](viator_dsp::Distortion<float>& distortion, const Spec& spec)
+            {
+                distortion.prepare(spec);
+                distortion.setClipperType(viator_dsp::Distortion<float>::ClipType::kSoft);
+                distortion.setDrive(12.0f);
+            },
+            [](viator_dsp::Distortion<float>& distortion, juce::dsp::AudioBlock<float>& block)
+            {
+                std::array<float*, 16> channels {};
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    channels[channel] = block.getChannelPointer(channel);
+                }
+
+                juce::AudioBuffer<float> buffer(channels.data(), static_cast<int>(block.getNumChannels()), static_cast<int>(block.getNumSamples()));
+                distortion.processBuffer(buffer);
+            }));
+
+        // The loop processBuffer() used to run: sample outer, channel inner, clipper and DC filter per sample
+        struct InterleavedDistortion
+        {
+            viator_dsp::Distortion<float> distortion;
+            juce::dsp::LinkwitzRileyFilter<float> dcFilter;
+        };
+
+        cases.push_back(makeBenchmarkCase<InterleavedDistortion, float>("Distortion/processBufferInterleaved",
+            [](InterleavedDistortion& interleaved, const Spec& spec)
+            {
+                interleaved.distortion.prepare(spec);
+                interleaved.distortion.setClipperType(viator_dsp::Distortion<float>::ClipType::kSoft);
+                interleaved.distortion.setDrive(12.0f);
+                interleaved.dcFilter.prepare(spec);
+                interleaved.dcFilter.setType(juce::dsp::LinkwitzRileyFilter<float>::Type::highpass);
+                interleaved.dcFilter.setCutoffFrequency(10.0f);
+            },
+            [](InterleavedDistortion& interleaved, juce::dsp::AudioBlock<float>& block)
+            {
+                for (size_t i = 0; i < block.getNumSamples(); ++i)
+                {
+                    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                    {
+                        auto& sample = block.getChannelPointer(channel)[i];
+                        sample = interleaved.distortion.processSample(sample, static_cast<int>(channel));
+                        sample = interleaved.dcFilter.processSample(static_cast<int>(channel), sample);
+                    }
+                }
+            }));
+
+        cases.push_back(makeBenchmarkCase<viator_dsp::BitCrusher<float>, float>("BitCrusher/processBuffer",
+            [](viator_dsp::BitCrusher<float>& crusher, const Spec& spec)
+            {
+                crusher.prepare(spec);
+                crusher.setBitDepth(8.0f);
+            },
+            [](viator_dsp::BitCrusher<float>& crusher, juce::dsp::AudioBlock<float>& block)
+            {
+                std::array<float*, 16> channels {};
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    channels[channel] = block.getChannelPointer(channel);
+                }
+
+                juce::AudioBuffer<float> buffer(channels.data(), static_cast<int>(block.getNumChannels()), static_cast<int>(block.getNumSamples()));
+                crusher.processBuffer(buffer);
+            }));
+
+        cases.push_back(makeBenchmarkCase<viator_dsp::BrickWallLPF, float>("BrickWallLPF",
+            [](viator_dsp::BrickWallLPF& filter, const Spec& spec) { filter.prepare(spec); },
+            [](viator_dsp::BrickWallLPF& filter, juce::dsp::AudioBlock<float>& block) { filter.process(juce::dsp::ProcessContextReplacing<float>(block)); },
+            static_cast<int>(juce::dsp::SIMDRegister<float>::size())));
+
+        // The same low pass as SVFilter/LowPass, one register of channels at a time. Includes the interleaving.
+        struct InterleavedSVFilter
+        {
+            using Register = juce::dsp::SIMDRegister<float>;
+
+            viator_dsp::SVFilter<Register> filter;
+            juce::HeapBlock<char> interleavedData;
+            juce::dsp::AudioBlock<Register> interleaved;
+        };
+
+        cases.push_back(makeBenchmarkCase<InterleavedSVFilter, float>("SVFilter/LowPassSIMD",
+            [](InterleavedSVFilter& simd, const Spec& spec)
+            {
+                using Register = InterleavedSVFilter::Register;
+
+                const auto numRegisters = (spec.numChannels + Register::size() - 1) / Register::size();
+                simd.interleaved = juce::dsp::AudioBlock<Register>(simd.interleavedData, numRegisters, spec.maximumBlockSize);
+                simd.interleaved.clear();
+
+                simd.filter.prepare({spec.sampleRate, spec.maximumBlockSize, static_cast<juce::uint32>(numRegisters)});
+                simd.filter.setParameter(viator_dsp::SVFilter<Register>::ParameterId::kType, viator_dsp::SVFilter<Register>::FilterType::kLowPass);
+                simd.filter.setParameter(viator_dsp::SVFilter<Register>::ParameterId::kCutoff, 1000.0f);
+                simd.filter.setParameter(viator_dsp::SVFilter<Register>::ParameterId::kQ, 0.3f);
+            },
+            [](InterleavedSVFilter& simd, juce::dsp::AudioBlock<float>& block)
+            {
+                using Register = InterleavedSVFilter::Register;
+
+                const auto numSamples = block.getNumSamples();
+                auto interleaved = simd.interleaved.getSubBlock(0, numSamples);
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    const auto* source = block.getChannelPointer(channel);
+                    auto* destination = interleaved.getChannelPointer(channel / Register::size());
+
+                    for (size_t i = 0; i < numSamples; ++i)
+                    {
+                        destination[i].set(channel % Register::size(), source[i]);
+                    }
+                }
+
+                simd.filter.process(juce::dsp::ProcessContextReplacing<Register>(interleaved));
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    const auto* source = interleaved.getChannelPointer(channel / Register::size());
+                    auto* destination = block.getChannelPointer(channel);
+
+                    for (size_t i = 0; i < numSamples; ++i)
+                    {
+                        destination[i] = source[i].get(channel % Register::size());
+                    }
+                }
+            }));
+
+        cases.push_back(makeBenchmarkCase<viator_dsp::LFOGenerator, float>("LFOGenerator",
+            [](viator_dsp::LFOGenerator& lfo, const Spec& spec)
+            {
+                lfo.prepare(spec);
+                lfo.setWaveType(viator_dsp::LFOGenerator::WaveType::kSine);
+                lfo.setParameter(viator_dsp::LFOGenerator::ParameterId::kFrequency, 2.0f);
+            },
+            [](viator_dsp::LFOGenerator& lfo, juce::dsp::AudioBlock<float>& block)
+            {
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    auto* data = block.getChannelPointer(channel);
+
+                    for (size_t i = 0; i < block.getNumSamples(); ++i)
+                    {
+                        data[i] = lfo.processSample(data[i]);
+                    }
+                }
+            }));
+    }
+
+    return cases;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "BenchmarkRunner.h"
+#include "../../Source/PluginProcessor.h"
+
+/** A headless BasicCompressorAudioProcessor driven the way a host drives it. */
+struct PluginHarness
+{
+    BasicCompressorAudioProcessor processor;
+    juce::MidiBuffer midi;
+
+    /** Where a host without double support would convert each block to and from */
+    juce::AudioBuffer<float> floatBuffer;
+
+    void prepare(const juce::dsp::ProcessSpec& spec, juce::AudioProcessor::ProcessingPrecision precision)
+    {
+        const auto numChannels = static_cast<int>(spec.numChannels);
+        const auto blockSize = static_cast<int>(spec.maximumBlockSize);
+
+        // Main bus only; the sidechain bus stays disabled
+        auto layout = processor.getBusesLayout();
+        layout.getChannelSet(true, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        layout.getChannelSet(false, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        layout.getChannelSet(true, 1) = juce::AudioChannelSet::disabled();
+        processor.setBusesLayout(layout);
+
+        // Keep the noise well over the threshold so the gain computer is doing real work
+        setParameter("threshold", -24.f);
+        setParameter("ratio", 3.f);
+
+        processor.releaseResources();
+        processor.setProcessingPrecision(precision);
+        processor.setRateAndBufferSizeDetails(spec.sampleRate, blockSize);
+        processor.prepareToPlay(spec.sampleRate, blockSize);
+
+        floatBuffer.setSize(numChannels, blockSize);
+    }
+
+    void setParameter(const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    template <typename SampleType>
+    void process(juce::dsp::AudioBlock<SampleType>& block)
+    {
+        auto buffer = wrap(block);
+        processor.processBlock(buffer, midi);
+    }
+
+    /** What a host's 64-bit engine does when the plugin only takes float: convert, process, convert back. */
+    void processThroughFloat(juce::dsp::AudioBlock<double>& block)
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = floatBuffer.getWritePointer(static_cast<int>(channel));
+            const auto* source = block.getChannelPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                samples[i] = static_cast<float>(source[i]);
+            }
+        }
+
+        juce::AudioBuffer<float> buffer(floatBuffer.getArrayOfWritePointers(), floatBuffer.getNumChannels(), numSamples);
+        processor.processBlock(buffer, midi);
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* destination = block.getChannelPointer(channel);
+            const auto* samples = floatBuffer.getReadPointer(static_cast<int>(channel));
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                destination[i] = static_cast<double>(samples[i]);
+            }
+        }
+    }
+
+private:
+
+    template <typename SampleType>
+    static juce::AudioBuffer<SampleType> wrap(juce::dsp::AudioBlock<SampleType>& block)
+    {
+        std::array<SampleType*, 16> channels {};
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            channels[channel] = block.getChannelPointer(channel);
+        }
+
+        // Refers to the block's memory, so nothing is copied or allocated
+        return juce::AudioBuffer<SampleType>(channels.data(), static_cast<int>(block.getNumChannels()), static_cast<int>(block.getNumSamples()));
+    }
+};
+
+/**
+    The whole plugin at float and at double precision, plus a double run that
+    goes through the float path with the conversions a host would add. The last
+    two together show what the native double path saves. The 4x case shows the
+    cost of oversampling the compressor and saturation, and the 4 band case the
+    cost of multiband mode.
+*/
+template <typename SampleType>
+std::vector<BenchmarkCase<SampleType>> createPluginBenchmarks()
+{
+    using Block = juce::dsp::AudioBlock<SampleType>;
+    using Spec = juce::dsp::ProcessSpec;
+
+    constexpr auto precision = std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                       : juce::AudioProcessor::singlePrecision;
+
+    constexpr auto maxChannels = TelemetryFrame::maxChannels;
+
+    std::vector<BenchmarkCase<SampleType>> cases;
+
+    cases.push_back(makeBenchmarkCase<PluginHarness, SampleType>("BasicCompressor/processBlock",
+        [precision](PluginHarness& harness, const Spec& spec) { harness.prepare(spec, precision); },
+        [](PluginHarness& harness, Block& block) { harness.process(block); },
+        maxChannels));
+
+    // Against processBlock, what the split and the three extra compressors cost
+    cases.push_back(makeBenchmarkCase<PluginHarness, SampleType>("BasicCompressor/processBlock4Band",
+        [precision](PluginHarness& harness, const Spec& spec)
+        {
+            harness.setParameter("bands", 3.f);
+            harness.prepare(spec, precision);
+        },
+        [](PluginHarness& harness, Block& block) { harness.process(block); },
+        maxChannels));
+
+    // 4x linear phase with the tube stage: the heaviest configuration users are likely to leave on
+    cases.push_back(makeBenchmarkCase<PluginHarness, SampleType>("BasicCompressor/processBlock4xTube",
+        [precision](PluginHarness& harness, const Spec& spec)
+        {
+            harness.setParameter("oversampling", 2.f);
+            harness.setParameter("oversamplingQuality", 1.f);
+            harness.setParameter("saturation", 3.f);
+            harness.setParameter("drive", 6.f);
+            harness.prepare(spec, precision);
+        },
+        [](PluginHarness& harness, Block& block) { harness.process(block); },
+        maxChannels));
+
+    if constexpr (std::is_same<SampleType, double>::value)
+    {
+        cases.push_back(makeBenchmarkCase<PluginHarness, double>("BasicCompressor/processBlockViaFloat",
+            [](PluginHarness& harness, const Spec& spec) { harness.prepare(spec, juce::AudioProcessor::singlePrecision); },
+            [](PluginHarness& harness, juce::dsp::AudioBlock<double>& block) { harness.processThroughFloat(block); },
+            maxChannels));
+    }
+
+    return cases;
+}
@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    Headless batch renderer: streams audio files through
+    BasicCompressorAudioProcessor faster than real time, one processor
+    instance per worker thread. Needs no audio device or display.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+
+struct RenderSettings
+{
+    juce::File outputDirectory;
+    int blockSize = 512;
+    int numThreads = juce::SystemStats::getNumCpus();
+    juce::StringPairArray parameters;
+};
+
+juce::CriticalSection consoleLock;
+
+void printLine(const juce::String& text)
+{
+    const juce::ScopedLock sl(consoleLock);
+    std::cout << text << std::endl;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: OfflineRender [options] <input files...>" << std::endl
+              << std::endl
+              << "  --output <dir>        Folder for the rendered files (default: next to each input)" << std::endl
+              << "  --block-size <n>      Samples per processBlock call (default: 512)" << std::endl
+              << "  --threads <n>         Worker threads (default: number of CPUs)" << std::endl
+              << "  --param <id>=<value>  Set a parameter in its own units, e.g. --param threshold=-18" << std::endl
+              << std::endl
+              << "WAV and AIFF inputs are written back in the same format and bit depth." << std::endl;
+}
+
+//==============================================================================
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(const juce::File& fileToRender, const RenderSettings& renderSettings)
+    : juce::ThreadPoolJob(fileToRender.getFileName()), inputFile(fileToRender), settings(renderSettings)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        succeeded = render();
+        return jobHasFinished;
+    }
+
+    bool hasSucceeded() const noexcept { return succeeded; }
+
+private:
+    bool render()
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+
+        if (reader == nullptr)
+        {
+            printLine("FAILED  " + inputFile.getFullPathName() + ": unreadable or unsupported format");
+            return false;
+        }
+
+        const auto numChannels = static_cast<int>(reader->numChannels);
+        const auto sampleRate = reader->sampleRate;
+        const auto lengthInSamples = reader->lengthInSamples;
+
+        // One private processor per job, so workers never share state
+        BasicCompressorAudioProcessor processor;
+
+        // Main bus only; the sidechain bus stays disabled so the detector follows the file
+        auto layout = processor.getBusesLayout();
+        layout.getChannelSet(true, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        layout.getChannelSet(false, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        layout.getChannelSet(true, 1) = juce::AudioChannelSet::disabled();
+
+        if (! processor.setBusesLayout(layout))
+        {
+            printLine("FAILED  " + inputFile.getFullPathName() + ": " + juce::String(numChannels) + " channels not supported");
+            return false;
+        }
+
+        if (! applyParameters(processor))
+        {
+            return false;
+        }
+
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(sampleRate, settings.blockSize);
+        processor.prepareToPlay(sampleRate, settings.blockSize);
+
+        auto writer = createWriter(*reader, formatManager);
+
+        if (writer == nullptr)
+        {
+            return false;
+        }
+
+        // Run latency samples of silence past the end, and drop the same amount from the start
+        const auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+        const auto totalToProcess = lengthInSamples + latency;
+
+        juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        for (juce::int64 position = 0; position < totalToProcess; position += settings.blockSize)
+        {
+            const auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(settings.blockSize), totalToProcess - position));
+
+            if (buffer.getNumSamples() != numSamples)
+            {
+                buffer.setSize(numChannels, numSamples, false, false, true);
+            }
+
+            // Reads past the end of the file come back as silence
+            reader->read(&buffer, 0, numSamples, position, true, true);
+
+            midi.clear();
+            processor.processBlock(buffer, midi);
+
+            const auto skip = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(numSamples), latency - position));
+
+            if (skip < numSamples && ! writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+            {
+                printLine("FAILED  " + inputFile.getFullPathName() + ": error writing output");
+                return false;
+            }
+        }
+
+        const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+        const auto audioSeconds = static_cast<double>(lengthInSamples) / sampleRate;
+        const auto realTimeFactor = elapsedSeconds > 0.0 ? audioSeconds / elapsedSeconds : 0.0;
+
+        processor.releaseResources();
+
+        printLine("OK      " + inputFile.getFileName()
+                  + "  " + juce::String(audioSeconds, 2) + " s audio in " + juce::String(elapsedSeconds, 3) + " s"
+                  + "  (" + juce::String(realTimeFactor, 1) + "x real time)");
+
+        return true;
+    }
+
+    bool applyParameters(BasicCompressorAudioProcessor& processor)
+    {
+        for (const auto& id : settings.parameters.getAllKeys())
+        {
+            auto* parameter = processor.apvts.getParameter(id);
+
+            if (parameter == nullptr)
+            {
+                printLine("FAILED  " + inputFile.getFullPathName() + ": unknown parameter '" + id + "'");
+                return false;
+            }
+
+            const auto value = settings.parameters[id].getFloatValue();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        return true;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatReader& reader, juce::AudioFormatManager& formatManager)
+    {
+        auto* format = formatManager.findFormatForFileExtension(inputFile.getFileExtension());
+
+        if (format == nullptr)
+        {
+            printLine("FAILED  " + inputFile.getFullPathName() + ": no writer for " + inputFile.getFileExtension());
+            return nullptr;
+        }
+
+        const auto directory = settings.outputDirectory == juce::File() ? inputFile.getParentDirectory() : settings.outputDirectory;
+        const auto outputFile = directory.getChildFile(inputFile.getFileNameWithoutExtension() + "_compressed" + inputFile.getFileExtension());
+
+        outputFile.deleteFile();
+        auto stream = outputFile.createOutputStream();
+
+        if (stream == nullptr)
+        {
+            printLine("FAILED  " + outputFile.getFullPathName() + ": cannot open for writing");
+            return nullptr;
+        }
+
+        const auto bitDepth = reader.bitsPerSample <= 16 ? 16 : (reader.bitsPerSample <= 24 ? 24 : 32);
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+                                                                                reader.sampleRate,
+                                                                                reader.numChannels,
+                                                                                bitDepth,
+                                                                                reader.metadataValues,
+                                                                                0));
+
+        if (writer == nullptr)
+        {
+            printLine("FAILED  " + outputFile.getFullPathName() + ": format rejected " + juce::String(bitDepth) + " bit output");
+            return nullptr;
+        }
+
+        // The writer owns the stream from here on
+        stream.release();
+        return writer;
+    }
+
+    juce::File inputFile;
+    const RenderSettings& settings;
+    bool succeeded = false;
+};
+
+bool parseArguments(const juce::StringArray& arguments, RenderSettings& settings, juce::Array<juce::File>& inputFiles)
+{
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        const auto& argument = arguments[i];
+        const auto hasValue = i + 1 < arguments.size();
+
+        if (argument == "--output" && hasValue)
+        {
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(arguments[++i]);
+        }
+        else if (argument == "--block-size" && hasValue)
+        {
+            settings.blockSize = arguments[++i].getIntValue();
+        }
+        else if (argument == "--threads" && hasValue)
+        {
+            settings.numThreads = arguments[++i].getIntValue();
+        }
+        else if (argument == "--param" && hasValue && arguments[i + 1].containsChar('='))
+        {
+            const auto assignment = arguments[++i];
+            settings.parameters.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                    assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+        else if (argument.startsWith("-"))
+        {
+            std::cerr << "Unknown or incomplete option: " << argument << std::endl;
+            return false;
+        }
+        else
+        {
+            inputFiles.add(juce::File::getCurrentWorkingDirectory().getChildFile(argument));
+        }
+    }
+
+    if (settings.blockSize <= 0 || settings.numThreads <= 0)
+    {
+        std::cerr << "--block-size and --threads must be positive" << std::endl;
+        return false;
+    }
+
+    if (settings.outputDirectory != juce::File() && ! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Cannot create output folder " << settings.outputDirectory.getFullPathName() << std::endl;
+        return false;
+    }
+
+    return ! inputFiles.isEmpty();
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // Provides the message manager the processor's parameter state expects; no window is ever opened
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+    }
+
+    RenderSettings settings;
+    juce::Array<juce::File> inputFiles;
+
+    if (! parseArguments(arguments, settings, inputFiles))
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::ThreadPool pool(juce::jmin(settings.numThreads, inputFiles.size()));
+    juce::OwnedArray<RenderJob> jobs;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (const auto& file : inputFiles)
+    {
+        pool.addJob(jobs.add(new RenderJob(file, settings)), false);
+    }
+
+    auto numFailed = 0;
+
+    for (auto* job : jobs)
+    {
+        pool.waitForJobToFinish(job, -1);
+
+        if (! job->hasSucceeded())
+        {
+            ++numFailed;
+        }
+    }
+
+    const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+
+    printLine(juce::String(jobs.size() - numFailed) + " of " + juce::String(jobs.size()) + " files rendered in "
+              + juce::String(elapsedSeconds, 2) + " s on " + juce::String(pool.getNumThreads()) + " threads");
+
+    return numFailed == 0 ? 0 : 1;
+}
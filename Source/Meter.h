@@ -16,6 +16,12 @@ public:
         g.setGradientFill(gradient);
         const auto scaledY = jmap(level, -60.f, 6.f, 0.f, static_cast<float>(getHeight()));
         g.fillRect(bounds.removeFromBottom(scaledY));
+        
+        if (clipping)
+        {
+            g.setColour(Colours::red);
+            g.fillRect(getLocalBounds().removeFromTop(4));
+        }
     
     }
     
@@ -31,9 +37,15 @@ public:
         level = value;
     }
     
+    void setClipping(const bool isClipping)
+    {
+        clipping = isClipping;
+    }
+    
 private:
     
     float level = -60.f;
+    bool clipping = false;
         
     ColourGradient gradient;
 };
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Lock-free bridge between the APVTS and the audio thread.
+
+    Each parameter gets its own listener that stores the raw value in an atomic
+    and bumps a shared version counter. The audio thread calls pull() once per
+    block: if the version hasn't moved it returns straight away, otherwise it copies
+    every value into a plain struct and reports that coefficients need refreshing.
+    No strings are built or parsed, and nothing is recomputed when nothing changed.
+*/
+class ParameterSnapshot
+{
+public:
+
+    /** Order must match the choice strings built in createParameterLayout(). */
+    static constexpr std::array<float, 16> ratioTable {1.f, 1.5f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 15.f, 20.f, 25.f, 50.f, 100.f};
+
+    static constexpr int maxCrossovers = 7;
+
+    /** Low shelf, two bells and a high shelf */
+    static constexpr int maxDynamicEQBands = viator_dsp::DynamicEQ<float>::maxBands;
+
+    /** Plain copy of everything the audio thread reads. */
+    struct Values
+    {
+        float attack = 50.f;
+        float release = 250.f;
+        float threshold = 0.f;
+        float ratio = 1.f;
+        float inputGain = 0.f;
+        float outputGain = 0.f;
+        float lookahead = 0.f;
+        float drive = 0.f;
+        float sidechainFrequency = 100.f;
+        int ratioIndex = 0;
+        int oversamplingOrder = 0;
+        int saturation = 0;
+        int linkMode = 0;
+        int sidechainFilter = 0;
+        int numBands = 1;
+        int partitionSize = 256;
+        std::array<float, maxCrossovers> crossovers {80.f, 250.f, 800.f, 2500.f, 5000.f, 9000.f, 14000.f};
+        std::array<float, maxDynamicEQBands> dynamicEQFrequencies {100.f, 500.f, 2500.f, 8000.f};
+        std::array<float, maxDynamicEQBands> dynamicEQThresholds {-24.f, -24.f, -24.f, -24.f};
+        std::array<float, maxDynamicEQBands> dynamicEQRanges {0.f, 0.f, 0.f, 0.f};
+        bool linearPhase = false;
+        bool linearPhaseCrossover = false;
+        bool dynamicEQ = false;
+        bool bypass = false;
+    };
+
+    enum Field
+    {
+        kAttack,
+        kRelease,
+        kThreshold,
+        kRatio,
+        kBypass,
+        kInputGain,
+        kOutputGain,
+        kLookahead,
+        kOversampling,
+        kOversamplingQuality,
+        kSaturation,
+        kDrive,
+        kLink,
+        kSidechainFilter,
+        kSidechainFrequency,
+        kBands,
+        kCrossover1,
+        kCrossover7 = kCrossover1 + maxCrossovers - 1,
+        kCrossoverMode,
+        kPartitionSize,
+        kDynamicEQ,
+        kDynamicEQFrequency1,
+        kDynamicEQThreshold1 = kDynamicEQFrequency1 + maxDynamicEQBands,
+        kDynamicEQRange1 = kDynamicEQThreshold1 + maxDynamicEQBands,
+        kNumFields = kDynamicEQRange1 + maxDynamicEQBands
+    };
+
+    explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& stateToWatch)
+    : state(stateToWatch)
+    {
+        for (int field = 0; field < kNumFields; ++field)
+        {
+            const auto id = getParameterID(static_cast<Field>(field));
+
+            rawValues[field].store(state.getRawParameterValue(id)->load());
+            listeners[field] = std::make_unique<FieldListener>(*this, field);
+            state.addParameterListener(id, listeners[field].get());
+        }
+    }
+
+    ~ParameterSnapshot()
+    {
+        for (int field = 0; field < kNumFields; ++field)
+        {
+            state.removeParameterListener(getParameterID(static_cast<Field>(field)), listeners[field].get());
+        }
+    }
+
+    /** Audio thread only. Refreshes values and returns true if anything changed since the last call. */
+    bool pull(Values& values) noexcept
+    {
+        const auto currentVersion = version.load(std::memory_order_acquire);
+
+        if (currentVersion == lastPulledVersion)
+        {
+            return false;
+        }
+
+        // A writer landing mid-copy bumps the version again, so the next block re-reads it
+        lastPulledVersion = currentVersion;
+
+        values.attack = rawValues[kAttack].load(std::memory_order_relaxed);
+        values.release = rawValues[kRelease].load(std::memory_order_relaxed);
+        values.threshold = rawValues[kThreshold].load(std::memory_order_relaxed);
+        values.inputGain = rawValues[kInputGain].load(std::memory_order_relaxed);
+        values.outputGain = rawValues[kOutputGain].load(std::memory_order_relaxed);
+        values.lookahead = rawValues[kLookahead].load(std::memory_order_relaxed);
+        values.bypass = rawValues[kBypass].load(std::memory_order_relaxed) >= 0.5f;
+        values.ratioIndex = juce::jlimit(0, static_cast<int>(ratioTable.size()) - 1,
+                                         juce::roundToInt(rawValues[kRatio].load(std::memory_order_relaxed)));
+        values.ratio = ratioTable[static_cast<size_t>(values.ratioIndex)];
+        values.oversamplingOrder = juce::roundToInt(rawValues[kOversampling].load(std::memory_order_relaxed));
+        values.linearPhase = juce::roundToInt(rawValues[kOversamplingQuality].load(std::memory_order_relaxed)) == 1;
+        values.saturation = juce::roundToInt(rawValues[kSaturation].load(std::memory_order_relaxed));
+        values.drive = rawValues[kDrive].load(std::memory_order_relaxed);
+        values.linkMode = juce::roundToInt(rawValues[kLink].load(std::memory_order_relaxed));
+        values.sidechainFilter = juce::roundToInt(rawValues[kSidechainFilter].load(std::memory_order_relaxed));
+        values.sidechainFrequency = rawValues[kSidechainFrequency].load(std::memory_order_relaxed);
+        values.numBands = juce::roundToInt(rawValues[kBands].load(std::memory_order_relaxed)) + 1;
+
+        for (int crossover = 0; crossover < maxCrossovers; ++crossover)
+        {
+            values.crossovers[static_cast<size_t>(crossover)] = rawValues[kCrossover1 + crossover].load(std::memory_order_relaxed);
+        }
+
+        values.linearPhaseCrossover = juce::roundToInt(rawValues[kCrossoverMode].load(std::memory_order_relaxed)) == 1;
+
+        // Choice index i is a partition of 64 << i samples
+        values.partitionSize = 64 << juce::jlimit(0, 4, juce::roundToInt(rawValues[kPartitionSize].load(std::memory_order_relaxed)));
+
+        values.dynamicEQ = rawValues[kDynamicEQ].load(std::memory_order_relaxed) >= 0.5f;
+
+        for (int band = 0; band < maxDynamicEQBands; ++band)
+        {
+            values.dynamicEQFrequencies[static_cast<size_t>(band)] = rawValues[kDynamicEQFrequency1 + band].load(std::memory_order_relaxed);
+            values.dynamicEQThresholds[static_cast<size_t>(band)] = rawValues[kDynamicEQThreshold1 + band].load(std::memory_order_relaxed);
+            values.dynamicEQRanges[static_cast<size_t>(band)] = rawValues[kDynamicEQRange1 + band].load(std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    /** Forces the next pull() to report a change, e.g. after prepareToPlay. */
+    void markDirty() noexcept
+    {
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+    static juce::String getParameterID(Field field)
+    {
+        switch (field)
+        {
+            case kAttack: return "attack";
+            case kRelease: return "release";
+            case kThreshold: return "threshold";
+            case kRatio: return "ratio";
+            case kBypass: return "bypass";
+            case kInputGain: return "inputGain";
+            case kOutputGain: return "outputGain";
+            case kLookahead: return "lookahead";
+            case kOversampling: return "oversampling";
+            case kOversamplingQuality: return "oversamplingQuality";
+            case kSaturation: return "saturation";
+            case kDrive: return "drive";
+            case kLink: return "link";
+            case kSidechainFilter: return "sidechainFilter";
+            case kSidechainFrequency: return "sidechainFrequency";
+            case kBands: return "bands";
+            case kCrossoverMode: return "crossoverMode";
+            case kPartitionSize: return "partitionSize";
+            case kDynamicEQ: return "dynamicEQ";
+            case kNumFields: break;
+            default: break;
+        }
+
+        if (field >= kCrossover1 && field <= kCrossover7)
+        {
+            return "crossover" + juce::String(field - kCrossover1 + 1);
+        }
+
+        if (field >= kDynamicEQFrequency1 && field < kDynamicEQThreshold1)
+        {
+            return "dynamicEQFrequency" + juce::String(field - kDynamicEQFrequency1 + 1);
+        }
+
+        if (field >= kDynamicEQThreshold1 && field < kDynamicEQRange1)
+        {
+            return "dynamicEQThreshold" + juce::String(field - kDynamicEQThreshold1 + 1);
+        }
+
+        if (field >= kDynamicEQRange1 && field < kNumFields)
+        {
+            return "dynamicEQRange" + juce::String(field - kDynamicEQRange1 + 1);
+        }
+
+        jassertfalse;
+        return {};
+    }
+
+private:
+
+    /** One listener per parameter, so a callback never has to look up which field it belongs to. */
+    struct FieldListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+        FieldListener(ParameterSnapshot& ownerToNotify, int fieldIndex)
+        : owner(ownerToNotify), field(fieldIndex)
+        {
+        }
+
+        void parameterChanged(const juce::String&, float newValue) override
+        {
+            owner.rawValues[field].store(newValue, std::memory_order_relaxed);
+            owner.version.fetch_add(1, std::memory_order_release);
+        }
+
+        ParameterSnapshot& owner;
+        const int field;
+    };
+
+    juce::AudioProcessorValueTreeState& state;
+
+    std::array<std::atomic<float>, kNumFields> rawValues;
+    std::array<std::unique_ptr<FieldListener>, kNumFields> listeners;
+
+    std::atomic<juce::uint32> version {1};
+    juce::uint32 lastPulledVersion {0};
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterSnapshot)
+};
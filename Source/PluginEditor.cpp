@@ -19,7 +19,11 @@ threshAttach(audioProcessor.apvts, "threshold", threshold),
 ratioAttach(audioProcessor.apvts, "ratio", ratio),
 inputGainAttach(audioProcessor.apvts, "inputGain", inputGain),
 outputGainAttach(audioProcessor.apvts, "outputGain", outputGain),
-bypassAttach(audioProcessor.apvts, "bypass", bypass)
+lookaheadAttach(audioProcessor.apvts, "lookahead", lookahead),
+driveAttach(audioProcessor.apvts, "drive", drive),
+sidechainFrequencyAttach(audioProcessor.apvts, "sidechainFrequency", sidechainFrequency),
+bypassAttach(audioProcessor.apvts, "bypass", bypass),
+waveView(audioProcessor.waveform)
 
 {
     // Make sure that before the constructor has finished, you've set the
@@ -31,30 +35,100 @@ bypassAttach(audioProcessor.apvts, "bypass", bypass)
         addAndMakeVisible(slider);
     }
     
-    addAndMakeVisible(audioProcessor.waveViewer);
-    audioProcessor.waveViewer.setColours(Colours::darkgrey, Colours::black);
+    addAndMakeVisible(waveView);
     
     addAndMakeVisible(waveZoom);
     waveZoom.setSliderStyle(Slider::SliderStyle::LinearHorizontal);
     waveZoom.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
     waveZoom.setRange(128, 1024);
     waveZoom.setValue(576);
+    waveView.setZoom(waveZoom.getValue());
     waveZoom.onValueChange = [this]()
     {
-        audioProcessor.waveViewer.setBufferSize(waveZoom.getValue());
+        waveView.setZoom(waveZoom.getValue());
     };
     
     addAndMakeVisible(bypass);
     prepTextButton(&bypass, "A/B");
     
-    addAndMakeVisible(inputMeterL);
-    addAndMakeVisible(inputMeterR);
-    addAndMakeVisible(outputMeterL);
-    addAndMakeVisible(outputMeterR);
+    prepComboBox(oversampling, "oversampling", oversamplingAttach);
+    prepComboBox(oversamplingQuality, "oversamplingQuality", oversamplingQualityAttach);
+    prepComboBox(saturation, "saturation", saturationAttach);
+    prepComboBox(link, "link", linkAttach);
+    prepComboBox(sidechainFilter, "sidechainFilter", sidechainFilterAttach);
+    prepComboBox(bands, "bands", bandsAttach);
+    bands.onChange = [this]()
+    {
+        updateCrossovers();
+    };
+    prepComboBox(crossoverMode, "crossoverMode", crossoverModeAttach);
+    crossoverMode.onChange = [this]()
+    {
+        updateCrossovers();
+    };
+    prepComboBox(partitionSize, "partitionSize", partitionSizeAttach);
+    
+    for (int crossover = 0; crossover < ParameterSnapshot::maxCrossovers; ++crossover)
+    {
+        auto& slider = crossovers[crossover];
+        slider.setSliderStyle(Slider::SliderStyle::LinearBar);
+        slider.setTextValueSuffix(" Hz");
+        addAndMakeVisible(slider);
+        
+        const auto id = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(ParameterSnapshot::kCrossover1 + crossover));
+        crossoverAttachments.push_back(std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, id, slider));
+    }
+    
+    updateCrossovers();
+    
+    addAndMakeVisible(dynamicEQ);
+    prepTextButton(&dynamicEQ, "Dyn EQ");
+    dynamicEQAttach = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "dynamicEQ", dynamicEQ);
+    dynamicEQ.onClick = [this]()
+    {
+        updateDynamicEQ();
+    };
+    
+    // Each band's frequency, threshold and range, side by side
+    for (int band = 0; band < ParameterSnapshot::maxDynamicEQBands; ++band)
+    {
+        const std::array<ParameterSnapshot::Field, 3> fields {ParameterSnapshot::kDynamicEQFrequency1, ParameterSnapshot::kDynamicEQThreshold1, ParameterSnapshot::kDynamicEQRange1};
+        const std::array<String, 3> suffixes {" Hz", " dB", " dB"};
+        
+        for (size_t control = 0; control < fields.size(); ++control)
+        {
+            auto& slider = dynamicEQSliders[static_cast<size_t>(band) * fields.size() + control];
+            slider.setSliderStyle(Slider::SliderStyle::LinearBar);
+            slider.setTextValueSuffix(suffixes[control]);
+            addAndMakeVisible(slider);
+            
+            const auto id = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(fields[control] + band));
+            dynamicEQAttachments.push_back(std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, id, slider));
+        }
+    }
+    
+    updateDynamicEQ();
+    
+    for (int channel = 0; channel < TelemetryFrame::maxChannels; ++channel)
+    {
+        addChildComponent(inputMeters[channel]);
+        addChildComponent(outputMeters[channel]);
+    }
+
+    setNumMeters(audioProcessor.getTotalNumOutputChannels());
+
+    for (int channel = 0; channel < TelemetryFrame::maxChannels; ++channel)
+    {
+        for (auto* smoother : {&inputLevels[channel], &outputLevels[channel]})
+        {
+            smoother->reset(refreshRateHz, 0.75);
+            smoother->setCurrentAndTargetValue(-1000.f);
+        }
+    }
 
-    startTimerHz(60);
+    startTimerHz(refreshRateHz);
     
-    setSize (600, 500);
+    setSize (700, 500 + dynamicEQBarHeight + multibandBarHeight);
 
 }
 
@@ -67,7 +141,10 @@ void BasicCompressorAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll(Colours::black);
-    auto bounds = getLocalBounds();
+    auto bounds = getMainBounds();
+    auto strips = getLocalBounds();
+    auto multibandBar = strips.removeFromBottom(multibandBarHeight).reduced(5.f);
+    auto dynamicEQBar = strips.removeFromBottom(dynamicEQBarHeight).reduced(5.f);
     auto titleBar = bounds.removeFromTop(bounds.getHeight() * 0.1).reduced(5.f);
     auto topArea = bounds.removeFromTop(bounds.getHeight() * 0.7).reduced(5.f);
     auto dials = bounds.reduced(5.f);
@@ -76,6 +153,12 @@ void BasicCompressorAudioProcessorEditor::paint (juce::Graphics& g)
     g.fillRect(topArea.toFloat());
     g.fillRect(dials.toFloat());
     g.fillRect(titleBar.toFloat());
+    g.fillRect(multibandBar.toFloat());
+    g.fillRect(dynamicEQBar.toFloat());
+    
+    g.setColour(Colours::black);
+    g.drawText("GR " + String(gainReduction, 1) + " dB (avg " + String(averageGainReduction, 1) + " dB)",
+               titleBar.reduced(10, 0), Justification::centredLeft);
     
 }
 
@@ -83,7 +166,7 @@ void BasicCompressorAudioProcessorEditor::paintOverChildren(Graphics& g)
 {
     if(*audioProcessor.bypassPtr == false)
     {
-        auto bounds = getLocalBounds();
+        auto bounds = getMainBounds();
         auto topArea = bounds.removeFromTop(bounds.getHeight() * 0.7).reduced(5.f);
         auto graphArea = topArea.removeFromLeft(topArea.getWidth() * 0.7).reduced(5.f);
         
@@ -114,12 +197,33 @@ void BasicCompressorAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
-    auto bounds = getLocalBounds();
+    auto strips = getLocalBounds();
+    auto multibandBar = strips.removeFromBottom(multibandBarHeight).reduced(10.f);
+    bands.setBounds(multibandBar.removeFromLeft(multibandBar.getWidth() / 8).reduced(2.f));
+    crossoverMode.setBounds(multibandBar.removeFromLeft(multibandBar.getWidth() / 6).reduced(2.f));
+    partitionSize.setBounds(multibandBar.removeFromLeft(multibandBar.getWidth() / 10).reduced(2.f));
+    
+    for (int crossover = 0; crossover < ParameterSnapshot::maxCrossovers; ++crossover)
+    {
+        const auto remaining = ParameterSnapshot::maxCrossovers - crossover;
+        crossovers[crossover].setBounds(multibandBar.removeFromLeft(multibandBar.getWidth() / remaining).reduced(2.f));
+    }
+    
+    auto dynamicEQBar = strips.removeFromBottom(dynamicEQBarHeight).reduced(10.f);
+    dynamicEQ.setBounds(dynamicEQBar.removeFromLeft(dynamicEQBar.getWidth() / 8).reduced(2.f));
+    
+    for (size_t slider = 0; slider < dynamicEQSliders.size(); ++slider)
+    {
+        const auto remaining = static_cast<int>(dynamicEQSliders.size() - slider);
+        dynamicEQSliders[slider].setBounds(dynamicEQBar.removeFromLeft(dynamicEQBar.getWidth() / remaining).reduced(2.f));
+    }
+    
+    auto bounds = getMainBounds();
     auto titleBar = bounds.removeFromTop(bounds.getHeight() * 0.1);
     auto topArea = bounds.removeFromTop(bounds.getHeight() * 0.7).reduced(5.f);
     auto waveViewerBounds = topArea.removeFromLeft(topArea.getWidth() * 0.7).reduced(5.f);
     waveZoom.setBounds(waveViewerBounds.removeFromBottom(waveViewerBounds.getHeight() * 0.2));
-    audioProcessor.waveViewer.setBounds(waveViewerBounds);
+    waveView.setBounds(waveViewerBounds);
     
     auto gainBounds = topArea;
     auto gainControl = gainBounds.removeFromTop(gainBounds.getHeight() * 0.3);
@@ -128,31 +232,181 @@ void BasicCompressorAudioProcessorEditor::resized()
     auto inMeterBounds = gainBounds.removeFromLeft(gainBounds.getWidth() * 0.5).reduced(10.f, 5.f);
     auto outMeterBounds = gainBounds.reduced(10.f, 5.f);
 
-    inputMeterL.setBounds(inMeterBounds.removeFromLeft(inMeterBounds.getWidth() * 0.5).reduced(2.5f, 0));
-    inputMeterR.setBounds(inMeterBounds.reduced(2.5f, 0));
-    outputMeterL.setBounds(outMeterBounds.removeFromLeft(outMeterBounds.getWidth() * 0.5).reduced(2.5f, 0));
-    outputMeterR.setBounds(outMeterBounds.reduced(2.5f, 0));
+    layoutMeters(inputMeters, inMeterBounds);
+    layoutMeters(outputMeters, outMeterBounds);
 
     
     bounds.reduced(10.f);
-    attack.setBounds(bounds.removeFromLeft(bounds.getWidth() * 0.25).reduced(10.f));
-    release.setBounds(bounds.removeFromLeft(bounds.getWidth() * 0.33).reduced(10.f));
-    threshold.setBounds(bounds.removeFromLeft(bounds.getWidth() * 0.5).reduced(10.f));
-    ratio.setBounds(bounds.reduced(10.f));
+    attack.setBounds(bounds.removeFromLeft(bounds.getWidth() / 7).reduced(10.f));
+    release.setBounds(bounds.removeFromLeft(bounds.getWidth() / 6).reduced(10.f));
+    threshold.setBounds(bounds.removeFromLeft(bounds.getWidth() / 5).reduced(10.f));
+    ratio.setBounds(bounds.removeFromLeft(bounds.getWidth() / 4).reduced(10.f));
+    lookahead.setBounds(bounds.removeFromLeft(bounds.getWidth() / 3).reduced(10.f));
+    drive.setBounds(bounds.removeFromLeft(bounds.getWidth() / 2).reduced(10.f));
+    sidechainFrequency.setBounds(bounds.reduced(10.f));
     bypass.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.1).reduced(5.f));
+    saturation.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.18).reduced(5.f));
+    oversamplingQuality.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.2).reduced(5.f));
+    oversampling.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.15).reduced(5.f));
+    link.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.2).reduced(5.f));
+    sidechainFilter.setBounds(titleBar.removeFromRight(titleBar.getWidth() * 0.3).reduced(5.f));
 }
 
 void BasicCompressorAudioProcessorEditor::timerCallback()
 {
-    inputMeterL.setLevel(audioProcessor.getRmsLevel(true, 0));
-    inputMeterR.setLevel(audioProcessor.getRmsLevel(true, 1));
-    outputMeterL.setLevel(audioProcessor.getRmsLevel(false, 0));
-    outputMeterR.setLevel(audioProcessor.getRmsLevel(false, 1));
+    // The host can change the layout while the editor is open
+    if (audioProcessor.getTotalNumOutputChannels() != numMeters)
+    {
+        setNumMeters(audioProcessor.getTotalNumOutputChannels());
+    }
+    
+    // Collapse every block since the last tick into one reading per channel
+    std::array<float, TelemetryFrame::maxChannels> inputRms, outputRms;
+    inputRms.fill(0.f);
+    outputRms.fill(0.f);
+    auto blockGainReduction = 0.f;
+    auto gainReductionSum = 0.f;
+    auto numGainReadings = 0;
+    auto bypassed = false;
+    
+    const auto numFrames = audioProcessor.telemetry.drain([&](const TelemetryFrame& frame)
+    {
+        bypassed = frame.bypassed;
+        
+        for (int channel = 0; channel < frame.numChannels; ++channel)
+        {
+            inputRms[channel] = jmax(inputRms[channel], frame.inputRms[channel]);
+            outputRms[channel] = jmax(outputRms[channel], frame.outputRms[channel]);
+            blockGainReduction = jmin(blockGainReduction, frame.gainReduction[channel]);
+            gainReductionSum += frame.averageGainReduction[channel];
+            ++numGainReadings;
+            
+            if (frame.inputClip[channel])
+                inputClipHold[channel] = refreshRateHz;
+            
+            if (frame.outputClip[channel])
+                outputClipHold[channel] = refreshRateHz;
+        }
+    });
+    
+    for (int channel = 0; channel < TelemetryFrame::maxChannels; ++channel)
+    {
+        inputLevels[channel].skip(1);
+        outputLevels[channel].skip(1);
+        
+        if (bypassed)
+        {
+            inputLevels[channel].setCurrentAndTargetValue(-1000.f);
+            outputLevels[channel].setCurrentAndTargetValue(-1000.f);
+        }
+        else if (numFrames > 0)
+        {
+            updateLevel(inputLevels[channel], Decibels::gainToDecibels(inputRms[channel]));
+            updateLevel(outputLevels[channel], Decibels::gainToDecibels(outputRms[channel]));
+        }
+        
+        inputClipHold[channel] = jmax(0, inputClipHold[channel] - 1);
+        outputClipHold[channel] = jmax(0, outputClipHold[channel] - 1);
+    }
+    
+    for (int channel = 0; channel < numMeters; ++channel)
+    {
+        inputMeters[channel].setLevel(inputLevels[channel].getCurrentValue());
+        outputMeters[channel].setLevel(outputLevels[channel].getCurrentValue());
+        
+        inputMeters[channel].setClipping(inputClipHold[channel] > 0);
+        outputMeters[channel].setClipping(outputClipHold[channel] > 0);
+        
+        inputMeters[channel].repaint();
+        outputMeters[channel].repaint();
+    }
+    
+    const auto blockAverage = numGainReadings > 0 ? gainReductionSum / numGainReadings : 0.f;
+    
+    if (numFrames > 0 && (blockGainReduction != gainReduction || blockAverage != averageGainReduction))
+    {
+        gainReduction = blockGainReduction;
+        averageGainReduction = blockAverage;
+        repaint(getTitleBarBounds());
+    }
+}
+
+void BasicCompressorAudioProcessorEditor::updateLevel(LinearSmoothedValue<float>& smoother, float newLevel)
+{
+    // Instant attack, 0.75 s linear fall
+    if (newLevel < smoother.getCurrentValue())
+    {
+        smoother.setTargetValue(newLevel);
+    }
+    else
+    {
+        smoother.setCurrentAndTargetValue(newLevel);
+    }
+}
+
+void BasicCompressorAudioProcessorEditor::setNumMeters(int newNumMeters)
+{
+    numMeters = jlimit(0, TelemetryFrame::maxChannels, newNumMeters);
+    
+    for (int channel = 0; channel < TelemetryFrame::maxChannels; ++channel)
+    {
+        inputMeters[channel].setVisible(channel < numMeters);
+        outputMeters[channel].setVisible(channel < numMeters);
+    }
+    
+    resized();
+}
+
+void BasicCompressorAudioProcessorEditor::layoutMeters(std::array<Meter, TelemetryFrame::maxChannels>& meters, juce::Rectangle<int> bounds)
+{
+    if (numMeters == 0)
+    {
+        return;
+    }
+    
+    // Side by side, thinner gaps once there are more than a couple of channels
+    const auto gap = numMeters > 2 ? 1.f : 2.5f;
+    const auto meterWidth = bounds.getWidth() / static_cast<float>(numMeters);
+    
+    for (int channel = 0; channel < numMeters; ++channel)
+    {
+        auto meterBounds = bounds.toFloat().withX(bounds.getX() + channel * meterWidth).withWidth(meterWidth);
+        meters[channel].setBounds(meterBounds.reduced(gap, 0).toNearestInt());
+    }
+}
+
+juce::Rectangle<int> BasicCompressorAudioProcessorEditor::getTitleBarBounds() const
+{
+    auto bounds = getMainBounds();
+    return bounds.removeFromTop(bounds.getHeight() * 0.1);
+}
+
+juce::Rectangle<int> BasicCompressorAudioProcessorEditor::getMainBounds() const
+{
+    return getLocalBounds().withTrimmedBottom(dynamicEQBarHeight + multibandBarHeight);
+}
+
+void BasicCompressorAudioProcessorEditor::updateCrossovers()
+{
+    // A 4 band split uses the first 3 crossovers
+    const auto numCrossovers = bands.getSelectedItemIndex();
     
-    inputMeterR.repaint();
-    inputMeterL.repaint();
-    outputMeterR.repaint();
-    outputMeterL.repaint();
+    for (int crossover = 0; crossover < ParameterSnapshot::maxCrossovers; ++crossover)
+    {
+        crossovers[crossover].setEnabled(crossover < numCrossovers);
+    }
+    
+    // Only the linear-phase split is partitioned
+    crossoverMode.setEnabled(numCrossovers > 0);
+    partitionSize.setEnabled(numCrossovers > 0 && crossoverMode.getSelectedItemIndex() == 1);
+}
+
+void BasicCompressorAudioProcessorEditor::updateDynamicEQ()
+{
+    for (auto& slider : dynamicEQSliders)
+    {
+        slider.setEnabled(dynamicEQ.getToggleState());
+    }
 }
 
 void BasicCompressorAudioProcessorEditor::prepTextButton(TextButton* button, String text)
@@ -165,6 +419,17 @@ void BasicCompressorAudioProcessorEditor::prepTextButton(TextButton* button, Str
     button->setClickingTogglesState(true);
 }
 
+void BasicCompressorAudioProcessorEditor::prepComboBox(ComboBox& box, const String& parameterId, std::unique_ptr<AudioProcessorValueTreeState::ComboBoxAttachment>& attachment)
+{
+    if (auto* choice = dynamic_cast<AudioParameterChoice*>(audioProcessor.apvts.getParameter(parameterId)))
+    {
+        box.addItemList(choice->choices, 1);
+    }
+    
+    attachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, parameterId, box);
+    addAndMakeVisible(box);
+}
+
 
 std::vector<juce::Slider*> BasicCompressorAudioProcessorEditor::getSliders()
 {
@@ -175,6 +440,9 @@ std::vector<juce::Slider*> BasicCompressorAudioProcessorEditor::getSliders()
         &threshold,
         &ratio,
         &inputGain,
-        &outputGain
+        &outputGain,
+        &lookahead,
+        &drive,
+        &sidechainFrequency
     };
 }
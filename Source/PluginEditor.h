@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "Meter.h"
+#include "WaveformView.h"
 
 //==============================================================================
 /**
@@ -35,14 +36,50 @@ private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     BasicCompressorAudioProcessor& audioProcessor;
-    Slider waveZoom, attack, release, threshold, ratio, inputGain, outputGain;
-    juce::AudioProcessorValueTreeState::SliderAttachment attackAttach, releaseAttach, threshAttach, ratioAttach, inputGainAttach, outputGainAttach;
+    Slider waveZoom, attack, release, threshold, ratio, inputGain, outputGain, lookahead, drive, sidechainFrequency;
+    juce::AudioProcessorValueTreeState::SliderAttachment attackAttach, releaseAttach, threshAttach, ratioAttach, inputGainAttach, outputGainAttach, lookaheadAttach, driveAttach, sidechainFrequencyAttach;
     TextButton bypass;
     AudioProcessorValueTreeState::ButtonAttachment bypassAttach;
+    
+    /** Attached in the constructor body, once the boxes hold their parameter's choices */
+    ComboBox oversampling, oversamplingQuality, saturation, link, sidechainFilter, bands, crossoverMode, partitionSize;
+    std::unique_ptr<AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttach, oversamplingQualityAttach, saturationAttach, linkAttach, sidechainFilterAttach, bandsAttach, crossoverModeAttach, partitionSizeAttach;
+    
+    /** Multiband strip along the bottom; only the crossovers in use are enabled */
+    static constexpr int multibandBarHeight = 50;
+    std::array<Slider, ParameterSnapshot::maxCrossovers> crossovers;
+    std::vector<std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment>> crossoverAttachments;
+    
+    /** Dynamic EQ strip above it: frequency, threshold and range per band, enabled with the stage */
+    static constexpr int dynamicEQBarHeight = 50;
+    TextButton dynamicEQ;
+    std::unique_ptr<AudioProcessorValueTreeState::ButtonAttachment> dynamicEQAttach;
+    std::array<Slider, 3 * ParameterSnapshot::maxDynamicEQBands> dynamicEQSliders;
+    std::vector<std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment>> dynamicEQAttachments;
 //    viator_gui::FilmStripKnob attack, release, threshold, ratio;
     
     
-    Meter inputMeterL, inputMeterR, outputMeterL, outputMeterR;
+    WaveformView waveView;
+    
+    /** One meter per channel of the current layout; the rest stay hidden */
+    std::array<Meter, TelemetryFrame::maxChannels> inputMeters, outputMeters;
+    int numMeters = 0;
+    
+    /** Meter ballistics, run here on the message thread from the drained telemetry */
+    static constexpr int refreshRateHz = 60;
+    std::array<LinearSmoothedValue<float>, TelemetryFrame::maxChannels> inputLevels, outputLevels;
+    std::array<int, TelemetryFrame::maxChannels> inputClipHold {}, outputClipHold {};
+    float gainReduction = 0.f;
+    float averageGainReduction = 0.f;
+    
+    void updateLevel(LinearSmoothedValue<float>& smoother, float newLevel);
+    void setNumMeters(int newNumMeters);
+    void layoutMeters(std::array<Meter, TelemetryFrame::maxChannels>& meters, juce::Rectangle<int> bounds);
+    juce::Rectangle<int> getTitleBarBounds() const;
+    juce::Rectangle<int> getMainBounds() const;
+    void updateCrossovers();
+    void updateDynamicEQ();
+    void prepComboBox(ComboBox& box, const String& parameterId, std::unique_ptr<AudioProcessorValueTreeState::ComboBoxAttachment>& attachment);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BasicCompressorAudioProcessorEditor)
 };
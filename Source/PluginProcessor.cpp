@@ -7,7 +7,9 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! BASICCOMPRESSOR_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
 //==============================================================================
 BasicCompressorAudioProcessor::BasicCompressorAudioProcessor()
@@ -16,11 +18,11 @@ BasicCompressorAudioProcessor::BasicCompressorAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       ),
-waveViewer(1)
+                       )
 #endif
 {
     ratioPtr = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("ratio"));
@@ -30,9 +32,7 @@ waveViewer(1)
     bypassPtr = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("bypass"));
     inputGainPtr = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("inputGain"));
     outputGainPtr = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("outputGain"));
-
-    waveViewer.setRepaintRate(30);
-    waveViewer.setBufferSize(256);
+    lookaheadPtr = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("lookahead"));
 }
 
 BasicCompressorAudioProcessor::~BasicCompressorAudioProcessor()
@@ -111,22 +111,19 @@ void BasicCompressorAudioProcessor::prepareToPlay (double sampleRate, int sample
     spec.numChannels = getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
     
-    rmsInLevelL.reset(sampleRate, 0.75);
-    rmsInLevelR.reset(sampleRate, 0.75);
-    rmsOutLevelL.reset(sampleRate, 0.75);
-    rmsOutLevelR.reset(sampleRate, 0.75);
-
-    rmsInLevelL.setCurrentAndTargetValue(-1000.f);
-    rmsInLevelR.setCurrentAndTargetValue(-1000.f);
-    rmsOutLevelL.setCurrentAndTargetValue(-1000.f);
-    rmsOutLevelR.setCurrentAndTargetValue(-1000.f);
-    
-    compressor.prepare(spec);
-    inputGain.prepare(spec);
-    outputGain.prepare(spec);
+    // The host picks the precision before preparing, so only that chain needs memory
+    if (isUsingDoublePrecision())
+    {
+        prepareChain<double>(spec);
+    }
+    else
+    {
+        prepareChain<float>(spec);
+    }
     
-    inputGain.setRampDurationSeconds(0.05);
-    outputGain.setRampDurationSeconds(0.05);
+    parameterSnapshot.markDirty();
+    parameterSnapshot.pull(parameters);
+    applyParameters();
 }
 
 void BasicCompressorAudioProcessor::releaseResources()
@@ -142,18 +139,22 @@ bool BasicCompressorAudioProcessor::isBusesLayoutSupported (const BusesLayout& l
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any named or discrete layout up to TelemetryFrame::maxChannels: mono, stereo,
+    // LCR, 5.1, 7.1.4, first to third order Ambisonics... The compressor links
+    // every channel to one detector, so the channel order doesn't matter to it.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels < 1 || numChannels > TelemetryFrame::maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // The sidechain is optional, and the detector takes at most a stereo pair from it
+    if (layouts.inputBuses.size() > 1 && layouts.getChannelSet(true, 1).size() > 2)
+        return false;
    #endif
 
     return true;
@@ -162,6 +163,109 @@ bool BasicCompressorAudioProcessor::isBusesLayoutSupported (const BusesLayout& l
 #endif
 
 void BasicCompressorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+void BasicCompressorAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+bool BasicCompressorAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::prepareChain(const juce::dsp::ProcessSpec& spec)
+{
+    using Oversampler = typename ProcessingChain<SampleType>::Oversampler;
+    
+    auto& chain = getChain<SampleType>();
+    
+    // The compressor is sized for the highest rate and retuned when the factor changes
+    auto oversampledSpec = spec;
+    oversampledSpec.sampleRate *= 1 << maxOversamplingOrder;
+    oversampledSpec.maximumBlockSize *= 1 << maxOversamplingOrder;
+    
+    chain.compressor.prepare(oversampledSpec);
+    chain.inputGain.prepare(spec);
+    chain.outputGain.prepare(spec);
+    
+    chain.inputGain.setRampDurationSeconds(0.05);
+    chain.outputGain.setRampDurationSeconds(0.05);
+    
+    chain.dynamicEQ.prepare(spec);
+    
+    using DynamicEQ = viator_dsp::DynamicEQ<SampleType>;
+    
+    // Band types never change, so they're set here rather than in applyParameters()
+    for (int band = 0; band < ParameterSnapshot::maxDynamicEQBands; ++band)
+    {
+        const auto type = band == 0 ? DynamicEQ::BandType::kLowShelf
+                        : band == ParameterSnapshot::maxDynamicEQBands - 1 ? DynamicEQ::BandType::kHighShelf
+                                                                          : DynamicEQ::BandType::kBell;
+        
+        chain.dynamicEQ.setBandType(band, type);
+    }
+    
+    // Wide enough for a stereo sidechain or a copy of every input channel
+    const auto numDetectorChannels = jmax(spec.numChannels, static_cast<juce::uint32>(2));
+    
+    chain.sidechainFilter.prepare({spec.sampleRate, spec.maximumBlockSize, numDetectorChannels});
+    chain.detectorBuffer.setSize(static_cast<int>(numDetectorChannels), static_cast<int>(spec.maximumBlockSize));
+    
+    // Like the compressor, sized for the highest rate
+    chain.splitter.prepare(oversampledSpec);
+    chain.detectorSplitter.prepare({oversampledSpec.sampleRate, oversampledSpec.maximumBlockSize, numDetectorChannels});
+    
+    for (auto& bandCompressor : chain.bandCompressors)
+    {
+        bandCompressor.prepare(oversampledSpec);
+    }
+    
+    for (int order = 0; order <= maxOversamplingOrder; ++order)
+    {
+        auto rateSpec = spec;
+        rateSpec.sampleRate *= 1 << order;
+        rateSpec.maximumBlockSize *= 1 << order;
+        
+        chain.distortions[order].prepare(rateSpec);
+        chain.tubes[order].prepare(rateSpec);
+    }
+    
+    for (int linearPhase = 0; linearPhase < 2; ++linearPhase)
+    {
+        const auto filterType = linearPhase == 1 ? Oversampler::filterHalfBandFIREquiripple
+                                                 : Oversampler::filterHalfBandPolyphaseIIR;
+        
+        for (int order = 1; order <= maxOversamplingOrder; ++order)
+        {
+            // Integer latency so the host's delay compensation lines up exactly
+            auto& oversampler = chain.oversamplers[linearPhase][order - 1];
+            oversampler = std::make_unique<Oversampler>(spec.numChannels, order, filterType, true, true);
+            oversampler->initProcessing(spec.maximumBlockSize);
+            
+            auto& detectorOversampler = chain.detectorOversamplers[linearPhase][order - 1];
+            detectorOversampler = std::make_unique<Oversampler>(numDetectorChannels, order, filterType, true, true);
+            detectorOversampler->initProcessing(spec.maximumBlockSize);
+        }
+    }
+    
+    // Makes applyParameters() pick the oversampler and retune the compressor
+    chain.oversampler = nullptr;
+    chain.detectorOversampler = nullptr;
+    chain.oversamplingOrder = -1;
+    chain.numBands = 0;
+    chain.partitionSize = 0;
+    
+    // No valid frequency, so applyParameters() sets up every dynamic EQ band
+    chain.dynamicEQFrequencies.fill(-1.f);
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& hostBuffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -174,56 +278,187 @@ void BasicCompressorAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
 //    // when they first compile a plugin, but obviously you don't need to keep
 //    // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        hostBuffer.clear (i, 0, hostBuffer.getNumSamples());
     
     
-    compressor.setRatio(ratioPtr->getCurrentChoiceName().getFloatValue());
-    compressor.setAttack(attackPtr->get());
-    compressor.setRelease(releasePtr->get());
-    compressor.setThreshold(thresholdPtr->get());
+    // Coefficients are only recomputed when a parameter actually moved
+    if (parameterSnapshot.pull(parameters))
+    {
+        applyParameters();
+    }
+    
+    // Both refer to the host's channels; the sidechain has no channels while its bus is disabled
+    auto buffer = getBusBuffer(hostBuffer, false, 0);
+    auto sidechainBuffer = getBusBuffer(hostBuffer, true, 1);
     
-    inputGain.setGainDecibels(inputGainPtr->get());
-    outputGain.setGainDecibels(outputGainPtr->get());
+    auto& chain = getChain<SampleType>();
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+    auto context = juce::dsp::ProcessContextReplacing<SampleType>(block);
     
-    auto block = juce::dsp::AudioBlock<float>(buffer);
-    auto context = juce::dsp::ProcessContextReplacing<float>(block);
+    TelemetryFrame frame;
+    frame.numChannels = jmin(buffer.getNumChannels(), TelemetryFrame::maxChannels);
+    frame.bypassed = parameters.bypass;
     
-    if(bypassPtr->get() != true)
+    if(parameters.bypass != true)
     {
-        inputGain.process(context);
-        storeRmsValue(rmsInLevelL, buffer, 0);
-        storeRmsValue(rmsInLevelR, buffer, 1);
+        chain.inputGain.process(context);
+        storeLevels(buffer, frame.numChannels, frame.inputPeak, frame.inputRms, frame.inputClip);
         
-        compressor.process(context);
+        // Ahead of the detector copy, so the compressor hears the corrected signal
+        if (parameters.dynamicEQ)
+        {
+            chain.dynamicEQ.process(context);
+        }
+        
+        processNonlinear(chain, block, getDetectorBlock(chain, sidechainBuffer, block), false);
+        
+        pushWaveform(buffer);
         
-        waveViewer.pushBuffer(buffer);
+        chain.outputGain.process(context);
+        storeLevels(buffer, frame.numChannels, frame.outputPeak, frame.outputRms, frame.outputClip);
         
-        outputGain.process(context);
-        storeRmsValue(rmsOutLevelL, buffer, 0);
-        storeRmsValue(rmsOutLevelR, buffer, 1);
+        storeGainReduction(chain, frame);
     }
     else
     {
-        waveViewer.pushBuffer(buffer);
+        // Keeps the oversampling and lookahead delays running so A/B comparisons stay time-aligned
+        processNonlinear(chain, block, {}, true);
+        
+        pushWaveform(buffer);
+    }
+    
+    // Never blocks: if the editor is closed or behind, the frame is dropped
+    telemetry.push(frame);
+}
+
+template <typename SampleType>
+juce::dsp::AudioBlock<SampleType> BasicCompressorAudioProcessor::getDetectorBlock(ProcessingChain<SampleType>& chain, juce::AudioBuffer<SampleType>& sidechainBuffer, juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto filtered = parameters.sidechainFilter != kSidechainFilterOff;
+    
+    if (sidechainBuffer.getNumChannels() > 0)
+    {
+        // The sidechain is an input-only bus, so it's ours to filter in place
+        auto detector = juce::dsp::AudioBlock<SampleType>(sidechainBuffer);
+        
+        if (filtered)
+        {
+            chain.sidechainFilter.process(juce::dsp::ProcessContextReplacing<SampleType>(detector));
+        }
         
-        rmsInLevelL.setCurrentAndTargetValue(-1000.f);
-        rmsInLevelR.setCurrentAndTargetValue(-1000.f);
-        rmsOutLevelL.setCurrentAndTargetValue(-1000.f);
-        rmsOutLevelR.setCurrentAndTargetValue(-1000.f);
+        return detector;
+    }
+    
+    if (! filtered)
+    {
+        return {};
+    }
+    
+    // Filtering the input's own detector needs a copy, or the filter would be heard
+    auto detector = juce::dsp::AudioBlock<SampleType>(chain.detectorBuffer)
+                        .getSubsetChannelBlock(0, block.getNumChannels())
+                        .getSubBlock(0, block.getNumSamples());
+    detector.copyFrom(block);
+    chain.sidechainFilter.process(juce::dsp::ProcessContextReplacing<SampleType>(detector));
+    
+    return detector;
+}
 
+template <typename SampleType>
+void BasicCompressorAudioProcessor::processNonlinear(ProcessingChain<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block, juce::dsp::AudioBlock<SampleType> detector, bool bypassed)
+{
+    const auto order = jmax(0, chain.oversamplingOrder);
+    auto oversampledBlock = chain.oversampler != nullptr ? chain.oversampler->processSamplesUp(block) : block;
+    auto context = juce::dsp::ProcessContextReplacing<SampleType>(oversampledBlock);
+    context.isBypassed = bypassed;
+    
+    if (detector.getNumChannels() > 0 && chain.detectorOversampler != nullptr)
+    {
+        detector = chain.detectorOversampler->processSamplesUp(detector);
+    }
+    
+    if (chain.numBands > 1)
+    {
+        processMultiband(chain, oversampledBlock, detector, bypassed);
+    }
+    else if (detector.getNumChannels() > 0)
+    {
+        chain.compressor.process(context, detector);
+    }
+    else
+    {
+        chain.compressor.process(context);
+    }
+    
+    if (! bypassed)
+    {
+        switch (parameters.saturation)
+        {
+            case kSaturationSoft:
+            case kSaturationWarm: chain.distortions[order].process(context); break;
+            case kSaturationTube: chain.tubes[order].process(context); break;
+            default: break;
+        }
+    }
+    
+    if (chain.oversampler != nullptr)
+    {
+        chain.oversampler->processSamplesDown(block);
+    }
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::processMultiband(ProcessingChain<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block, juce::dsp::AudioBlock<SampleType> detector, bool bypassed)
+{
+    const auto keyed = detector.getNumChannels() > 0;
+    
+    chain.splitter.process(block);
+    
+    if (keyed)
+    {
+        chain.detectorSplitter.process(detector);
+    }
+    
+    // The bands are phase aligned, so the sum is flat; bypass still splits so A/B only removes the compression
+    block.clear();
+    
+    for (int band = 0; band < chain.numBands; ++band)
+    {
+        auto bandBlock = chain.splitter.getBand(band);
+        auto context = juce::dsp::ProcessContextReplacing<SampleType>(bandBlock);
+        context.isBypassed = bypassed;
+        
+        if (keyed)
+        {
+            chain.bandCompressors[band].process(context, chain.detectorSplitter.getBand(band));
+        }
+        else
+        {
+            chain.bandCompressors[band].process(context);
+        }
+        
+        block.add(bandBlock);
     }
 }
 
 //==============================================================================
 bool BasicCompressorAudioProcessor::hasEditor() const
 {
+   #if BASICCOMPRESSOR_HEADLESS
+    return false; // Offline tools build the processor without the editor sources
+   #else
     return true; // (change this to false if you choose to not supply an editor)
+   #endif
 }
 
 juce::AudioProcessorEditor* BasicCompressorAudioProcessor::createEditor()
 {
+   #if BASICCOMPRESSOR_HEADLESS
+    return nullptr;
+   #else
     return new BasicCompressorAudioProcessorEditor (*this);
 //    return new GenericAudioProcessorEditor(*this);
+   #endif
 }
 
 //==============================================================================
@@ -245,9 +480,8 @@ AudioProcessorValueTreeState::ParameterLayout BasicCompressorAudioProcessor::cre
 {
     AudioProcessorValueTreeState::ParameterLayout layout;
     
-    auto ratioChoices = std::vector<double> {1, 1.5, 2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 50, 100};
     StringArray ratioChoicesArray;
-    for(auto choice : ratioChoices)
+    for(auto choice : ParameterSnapshot::ratioTable)
     {
         ratioChoicesArray.add(juce::String(choice, 1));
     }
@@ -283,57 +517,326 @@ AudioProcessorValueTreeState::ParameterLayout BasicCompressorAudioProcessor::cre
                                                      "outputGain",
                                                      gainRange,
                                                      0));
+    layout.add(std::make_unique<AudioParameterFloat>("lookahead",
+                                                     "lookahead",
+                                                     NormalisableRange<float>(0.f, 20.f, 0.1f, 1.f),
+                                                     0.f));
+    layout.add(std::make_unique<AudioParameterChoice>("oversampling",
+                                                      "oversampling",
+                                                      StringArray {"Off", "2x", "4x", "8x", "16x"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("oversamplingQuality",
+                                                      "oversamplingQuality",
+                                                      StringArray {"IIR", "Linear phase"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("link",
+                                                      "link",
+                                                      StringArray {"Unlinked", "Max", "Average", "Mid/Side"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("sidechainFilter",
+                                                      "sidechainFilter",
+                                                      StringArray {"Off", "High pass", "Band pass"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterFloat>("sidechainFrequency",
+                                                     "sidechainFrequency",
+                                                     NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                     100.f));
+    layout.add(std::make_unique<AudioParameterChoice>("bands",
+                                                      "bands",
+                                                      StringArray {"1 band", "2 bands", "3 bands", "4 bands", "5 bands", "6 bands", "7 bands", "8 bands"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("crossoverMode",
+                                                      "crossoverMode",
+                                                      StringArray {"Minimum phase", "Linear phase"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("partitionSize",
+                                                      "partitionSize",
+                                                      StringArray {"64", "128", "256", "512", "1024"},
+                                                      2));
+    
+    const ParameterSnapshot::Values defaults;
+    
+    for (int crossover = 0; crossover < ParameterSnapshot::maxCrossovers; ++crossover)
+    {
+        const auto id = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(ParameterSnapshot::kCrossover1 + crossover));
+        
+        layout.add(std::make_unique<AudioParameterFloat>(id,
+                                                         id,
+                                                         NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                         defaults.crossovers[static_cast<size_t>(crossover)]));
+    }
+    
+    layout.add(std::make_unique<AudioParameterBool>("dynamicEQ",
+                                                    "dynamicEQ",
+                                                    false));
+    
+    for (int band = 0; band < ParameterSnapshot::maxDynamicEQBands; ++band)
+    {
+        const auto frequencyID = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(ParameterSnapshot::kDynamicEQFrequency1 + band));
+        const auto thresholdID = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(ParameterSnapshot::kDynamicEQThreshold1 + band));
+        const auto rangeID = ParameterSnapshot::getParameterID(static_cast<ParameterSnapshot::Field>(ParameterSnapshot::kDynamicEQRange1 + band));
+        
+        layout.add(std::make_unique<AudioParameterFloat>(frequencyID,
+                                                         frequencyID,
+                                                         NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                         defaults.dynamicEQFrequencies[static_cast<size_t>(band)]));
+        layout.add(std::make_unique<AudioParameterFloat>(thresholdID,
+                                                         thresholdID,
+                                                         NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+                                                         defaults.dynamicEQThresholds[static_cast<size_t>(band)]));
+        layout.add(std::make_unique<AudioParameterFloat>(rangeID,
+                                                         rangeID,
+                                                         NormalisableRange<float>(-18.f, 18.f, 0.5f, 1.f),
+                                                         defaults.dynamicEQRanges[static_cast<size_t>(band)]));
+    }
+    
+    layout.add(std::make_unique<AudioParameterChoice>("saturation",
+                                                      "saturation",
+                                                      StringArray {"Off", "Soft", "Warm", "Tube"},
+                                                      0));
+    layout.add(std::make_unique<AudioParameterFloat>("drive",
+                                                     "drive",
+                                                     NormalisableRange<float>(0.f, 24.f, 0.1f, 1.f),
+                                                     0.f));
     
     return layout;
     
 }
 
-float BasicCompressorAudioProcessor::getRmsLevel(bool inOut, const int channel)
+void BasicCompressorAudioProcessor::applyParameters()
 {
-    if(inOut)
+    if (isUsingDoublePrecision())
     {
-        if(channel == 0)
+        applyParameters(getChain<double>());
+    }
+    else
+    {
+        applyParameters(getChain<float>());
+    }
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::applyParameters(ProcessingChain<SampleType>& chain)
+{
+    using Distortion = viator_dsp::Distortion<SampleType>;
+    
+    const auto order = jlimit(0, maxOversamplingOrder, parameters.oversamplingOrder);
+    
+    if (order != chain.oversamplingOrder || parameters.linearPhase != chain.linearPhase)
+    {
+        chain.oversamplingOrder = order;
+        chain.linearPhase = parameters.linearPhase;
+        chain.oversampler = order > 0 ? chain.oversamplers[parameters.linearPhase ? 1 : 0][order - 1].get() : nullptr;
+        chain.detectorOversampler = order > 0 ? chain.detectorOversamplers[parameters.linearPhase ? 1 : 0][order - 1].get() : nullptr;
+        
+        if (chain.oversampler != nullptr)
+        {
+            chain.oversampler->reset();
+            chain.detectorOversampler->reset();
+        }
+        
+        // Old delay line contents were recorded at the previous rate
+        const auto rate = getSampleRate() * (1 << order);
+        
+        chain.compressor.setSampleRate(rate);
+        chain.compressor.reset();
+        chain.splitter.setSampleRate(rate);
+        chain.splitter.reset();
+        chain.detectorSplitter.setSampleRate(rate);
+        chain.detectorSplitter.reset();
+        
+        for (auto& bandCompressor : chain.bandCompressors)
         {
-            return rmsInLevelL.getCurrentValue();
+            bandCompressor.setSampleRate(rate);
+            bandCompressor.reset();
         }
-        if(channel == 1)
+    }
+    
+    const auto numBands = jlimit(1, maxBands, parameters.numBands);
+    
+    if (numBands != chain.numBands)
+    {
+        chain.numBands = numBands;
+        
+        if (numBands > 1)
         {
-            return rmsInLevelR.getCurrentValue();
+            chain.splitter.setNumBands(numBands);
+            chain.detectorSplitter.setNumBands(numBands);
         }
-        else
+        
+        // The other mode's delay lines hold stale audio
+        chain.compressor.reset();
+        chain.splitter.reset();
+        chain.detectorSplitter.reset();
+        
+        for (auto& bandCompressor : chain.bandCompressors)
         {
-            return 0;
+            bandCompressor.reset();
         }
     }
-    else
+    
+    for (int crossover = 0; crossover < ParameterSnapshot::maxCrossovers; ++crossover)
     {
-        if(channel == 0)
+        chain.splitter.setCrossoverFrequency(crossover, parameters.crossovers[static_cast<size_t>(crossover)]);
+        chain.detectorSplitter.setCrossoverFrequency(crossover, parameters.crossovers[static_cast<size_t>(crossover)]);
+    }
+    
+    using CrossoverMode = typename viator_dsp::MultiBandProcessor<SampleType>::CrossoverMode;
+    
+    const auto crossoverMode = parameters.linearPhaseCrossover ? CrossoverMode::kLinearPhase : CrossoverMode::kMinimumPhase;
+    
+    chain.splitter.setCrossoverMode(crossoverMode);
+    chain.detectorSplitter.setCrossoverMode(crossoverMode);
+    
+    // Both clear their convolution state, so only when it really moved
+    if (parameters.partitionSize != chain.partitionSize)
+    {
+        chain.partitionSize = parameters.partitionSize;
+        chain.splitter.setPartitionSize(chain.partitionSize);
+        chain.detectorSplitter.setPartitionSize(chain.partitionSize);
+    }
+    
+    // Whole host samples, so the oversampled delay is an exact multiple of the factor
+    const auto lookaheadSamples = roundToInt(parameters.lookahead * 0.001 * getSampleRate());
+    
+    // Every band shares the main settings; only their gain computers are independent
+    auto configure = [this, lookaheadSamples](viator_dsp::Compressor<SampleType>& compressor)
+    {
+        compressor.setRatio(parameters.ratio);
+        compressor.setAttack(parameters.attack);
+        compressor.setRelease(parameters.release);
+        compressor.setThreshold(parameters.threshold);
+        compressor.setLookahead(static_cast<SampleType>(lookaheadSamples * 1000.0 / getSampleRate()));
+        
+        // Choice order matches LinkMode
+        compressor.setLinkMode(static_cast<typename viator_dsp::Compressor<SampleType>::LinkMode>(jlimit(0, 3, parameters.linkMode)));
+    };
+    
+    configure(chain.compressor);
+    
+    for (auto& bandCompressor : chain.bandCompressors)
+    {
+        configure(bandCompressor);
+    }
+    
+    // Only what changed is passed on, since a new frequency costs a filter redesign
+    const auto setUpDynamicEQ = chain.dynamicEQFrequencies[0] < 0.f;
+    
+    if (parameters.dynamicEQ != chain.dynamicEQEnabled || setUpDynamicEQ)
+    {
+        chain.dynamicEQEnabled = parameters.dynamicEQ;
+        
+        // Switching the stage back on starts every band from its static response
+        for (int band = 0; band < ParameterSnapshot::maxDynamicEQBands; ++band)
+        {
+            chain.dynamicEQ.setBandEnabled(band, parameters.dynamicEQ);
+        }
+    }
+    
+    for (int band = 0; band < ParameterSnapshot::maxDynamicEQBands; ++band)
+    {
+        const auto index = static_cast<size_t>(band);
+        
+        if (parameters.dynamicEQFrequencies[index] != chain.dynamicEQFrequencies[index])
         {
-            return rmsOutLevelL.getCurrentValue();
+            chain.dynamicEQFrequencies[index] = parameters.dynamicEQFrequencies[index];
+            chain.dynamicEQ.setFrequency(band, parameters.dynamicEQFrequencies[index]);
         }
-        if(channel == 1)
+        
+        if (parameters.dynamicEQThresholds[index] != chain.dynamicEQThresholds[index] || setUpDynamicEQ)
         {
-            return rmsOutLevelR.getCurrentValue();
+            chain.dynamicEQThresholds[index] = parameters.dynamicEQThresholds[index];
+            chain.dynamicEQ.setThreshold(band, parameters.dynamicEQThresholds[index]);
         }
-        else
+        
+        if (parameters.dynamicEQRanges[index] != chain.dynamicEQRanges[index] || setUpDynamicEQ)
         {
-            return 0;
+            chain.dynamicEQRanges[index] = parameters.dynamicEQRanges[index];
+            chain.dynamicEQ.setRange(band, parameters.dynamicEQRanges[index]);
         }
     }
+    
+    using SVFilter = viator_dsp::SVFilter<SampleType>;
+    
+    chain.sidechainFilter.setParameter(SVFilter::ParameterId::kType, parameters.sidechainFilter == kSidechainBandPass ? SVFilter::FilterType::kBandPass
+                                                                                                                   : SVFilter::FilterType::kHighPass);
+    chain.sidechainFilter.setParameter(SVFilter::ParameterId::kCutoff, parameters.sidechainFrequency);
+    chain.sidechainFilter.setParameter(SVFilter::ParameterId::kQ, 0.3);
+    
+    for (auto& distortion : chain.distortions)
+    {
+        distortion.setClipperType(parameters.saturation == kSaturationWarm ? Distortion::ClipType::kSaturation
+                                                                           : Distortion::ClipType::kSoft);
+        distortion.setDrive(parameters.drive);
+    }
+    
+    for (auto& tube : chain.tubes)
+    {
+        tube.setDrive(parameters.drive);
+        tube.setMix(1);
+    }
+    
+    chain.inputGain.setGainDecibels(parameters.inputGain);
+    chain.outputGain.setGainDecibels(parameters.outputGain);
+    
+    // Lookahead and the oversampling filters delay the audio path, so keep the host's delay compensation in step
+    const auto oversamplingLatency = chain.oversampler != nullptr ? roundToInt(chain.oversampler->getLatencyInSamples()) : 0;
+    
+    // The linear-phase split runs at the oversampled rate; its latency is a multiple of 16, so it divides exactly
+    const auto crossoverLatency = chain.numBands > 1 ? chain.splitter.getLatencySamples() >> order : 0;
+    const auto latency = lookaheadSamples + oversamplingLatency + crossoverLatency;
+    
+    if (latency != getLatencySamples())
+    {
+        setLatencySamples(latency);
+    }
 }
 
-void BasicCompressorAudioProcessor::storeRmsValue(LinearSmoothedValue<float>& rmsMember, juce::AudioBuffer<float>& buffer, const int channel)
+template <typename SampleType>
+void BasicCompressorAudioProcessor::pushWaveform(juce::AudioBuffer<SampleType>& buffer)
 {
-    rmsMember.skip(buffer.getNumSamples());
-    
-    auto value = Decibels::gainToDecibels(buffer.getRMSLevel(channel, 0, buffer.getNumSamples()));
-    if (value < rmsMember.getCurrentValue())
+    // Only costs anything while an editor is showing the waveform
+    if (waveform.isActive())
     {
-        rmsMember.setTargetValue(value);
+        waveform.push(buffer);
     }
-    else
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::storeGainReduction(ProcessingChain<SampleType>& chain, TelemetryFrame& frame)
+{
+    for (int channel = 0; channel < frame.numChannels; ++channel)
     {
-        rmsMember.setCurrentAndTargetValue(value);
+        auto gainReduction = chain.compressor.getGainReduction(channel);
+        auto averageGainReduction = chain.compressor.getAverageGainReduction(channel);
+        
+        if (chain.numBands > 1)
+        {
+            gainReduction = averageGainReduction = 0;
+            
+            for (int band = 0; band < chain.numBands; ++band)
+            {
+                gainReduction = jmin(gainReduction, chain.bandCompressors[band].getGainReduction(channel));
+                averageGainReduction = jmin(averageGainReduction, chain.bandCompressors[band].getAverageGainReduction(channel));
+            }
+        }
+        
+        frame.gainReduction[channel] = static_cast<float>(gainReduction);
+        frame.averageGainReduction[channel] = static_cast<float>(averageGainReduction);
+    }
+}
+
+template <typename SampleType>
+void BasicCompressorAudioProcessor::storeLevels(juce::AudioBuffer<SampleType>& buffer, int numChannels, LevelArray& peak, LevelArray& rms, ClipArray& clip)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        // Peak, RMS and clip from one read of the channel, at the processing precision
+        const auto levels = viator_dsp::LevelAnalyser<SampleType>::analyse(buffer.getReadPointer(channel), buffer.getNumSamples());
+        
+        peak[channel] = static_cast<float>(levels.getPeak());
+        rms[channel] = static_cast<float>(levels.getRms());
+        clip[channel] = peak[channel] > 1.f;
     }
 }
 
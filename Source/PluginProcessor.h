@@ -9,6 +9,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "Telemetry.h"
+#include "WaveformBuffer.h"
 
 //==============================================================================
 /**
@@ -32,6 +35,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -65,26 +70,132 @@ public:
         createParameterLayout()
     };
     
-    juce::AudioVisualiserComponent waveViewer;
+    WaveformBuffer waveform;
     
     juce::AudioParameterFloat* attackPtr {nullptr};
     juce::AudioParameterFloat* releasePtr {nullptr};
     juce::AudioParameterFloat* thresholdPtr {nullptr};
     juce::AudioParameterFloat* inputGainPtr {nullptr};
     juce::AudioParameterFloat* outputGainPtr {nullptr};
+    juce::AudioParameterFloat* lookaheadPtr {nullptr};
     juce::AudioParameterChoice* ratioPtr {nullptr};
     juce::AudioParameterBool* bypassPtr {nullptr};
     
-    float getRmsLevel(bool inOut, const int channel);
+    /** Per-block levels for the editor; written only by the audio thread, drained only by the editor. */
+    TelemetryFifo telemetry;
 
 private:
-    void storeRmsValue(LinearSmoothedValue<float>& rmsMember, juce::AudioBuffer<float>& buffer, const int channel);
+    using LevelArray = std::array<float, TelemetryFrame::maxChannels>;
+    using ClipArray = std::array<bool, TelemetryFrame::maxChannels>;
     
-    juce::dsp::Compressor<float> compressor;
+    /** Choice order of the "saturation" parameter */
+    enum SaturationType
+    {
+        kSaturationOff,
+        kSaturationSoft,
+        kSaturationWarm,
+        kSaturationTube
+    };
+    
+    /** Choice order of the "sidechainFilter" parameter */
+    enum SidechainFilterType
+    {
+        kSidechainFilterOff,
+        kSidechainHighPass,
+        kSidechainBandPass
+    };
+    
+    /** Oversampling runs at 2^order times the host rate, up to 16x */
+    static constexpr int maxOversamplingOrder = 4;
+    
+    static constexpr int maxBands = viator_dsp::MultiBandProcessor<float>::maxBands;
+    
+    /** The DSP that runs at the host's precision; one of these exists per sample type. */
+    template <typename SampleType>
+    struct ProcessingChain
+    {
+        using Oversampler = juce::dsp::Oversampling<SampleType>;
+        
+        viator_dsp::Compressor<SampleType> compressor;
+        juce::dsp::Gain<SampleType> inputGain, outputGain;
+        
+        /** Optional stage ahead of the compressor, at the host rate */
+        viator_dsp::DynamicEQ<SampleType> dynamicEQ;
+        
+        /** What applyParameters() last gave dynamicEQ, so unchanged bands skip the filter redesign */
+        std::array<float, ParameterSnapshot::maxDynamicEQBands> dynamicEQFrequencies {}, dynamicEQThresholds {}, dynamicEQRanges {};
+        bool dynamicEQEnabled = false;
+        
+        /** Multiband mode: the input and detector split the same way, one compressor per band */
+        viator_dsp::MultiBandProcessor<SampleType> splitter, detectorSplitter;
+        std::array<viator_dsp::Compressor<SampleType>, maxBands> bandCompressors;
+        int numBands = 0;
+        int partitionSize = 0;
+        
+        /** Every order for both filter types, built in prepareToPlay so switching never allocates. [linearPhase][order - 1] */
+        std::array<std::array<std::unique_ptr<Oversampler>, maxOversamplingOrder>, 2> oversamplers;
+        
+        /** One saturator per rate, each prepared at its own rate. [order] */
+        std::array<viator_dsp::Distortion<SampleType>, maxOversamplingOrder + 1> distortions;
+        std::array<viator_dsp::Tube<SampleType>, maxOversamplingOrder + 1> tubes;
+        
+        /** Filters only what the detector hears. detectorBuffer holds a copy of the input when there's no external sidechain. */
+        viator_dsp::SVFilter<SampleType> sidechainFilter;
+        juce::AudioBuffer<SampleType> detectorBuffer;
+        
+        /** Bring the detector to the compressor's rate with the same delay as the audio. [linearPhase][order - 1] */
+        std::array<std::array<std::unique_ptr<Oversampler>, maxOversamplingOrder>, 2> detectorOversamplers;
+        
+        Oversampler* oversampler = nullptr;
+        Oversampler* detectorOversampler = nullptr;
+        int oversamplingOrder = -1;
+        bool linearPhase = false;
+    };
+    
+    template <typename SampleType>
+    ProcessingChain<SampleType>& getChain() noexcept
+    {
+        return std::get<ProcessingChain<SampleType>>(chains);
+    }
+    
+    template <typename SampleType>
+    void prepareChain(const juce::dsp::ProcessSpec& spec);
+    
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    
+    /** The block the detector should hear, or an empty block to follow the input. Never copies an external sidechain. */
+    template <typename SampleType>
+    juce::dsp::AudioBlock<SampleType> getDetectorBlock(ProcessingChain<SampleType>& chain, juce::AudioBuffer<SampleType>& sidechainBuffer, juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** Compressor and saturation, oversampled when that's switched on. Bypass still runs the delays. */
+    template <typename SampleType>
+    void processNonlinear(ProcessingChain<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block, juce::dsp::AudioBlock<SampleType> detector, bool bypassed);
+    
+    /** Splits the block, compresses every band on its own and sums them back in place. */
+    template <typename SampleType>
+    void processMultiband(ProcessingChain<SampleType>& chain, juce::dsp::AudioBlock<SampleType>& block, juce::dsp::AudioBlock<SampleType> detector, bool bypassed);
+    
+    template <typename SampleType>
+    void applyParameters(ProcessingChain<SampleType>& chain);
+    
+    void applyParameters();
+    
+    template <typename SampleType>
+    void pushWaveform(juce::AudioBuffer<SampleType>& buffer);
+    
+    /** In multiband mode, the deepest reduction of any band */
+    template <typename SampleType>
+    void storeGainReduction(ProcessingChain<SampleType>& chain, TelemetryFrame& frame);
+    
+    template <typename SampleType>
+    void storeLevels(juce::AudioBuffer<SampleType>& buffer, int numChannels, LevelArray& peak, LevelArray& rms, ClipArray& clip);
     
-    LinearSmoothedValue<float> rmsInLevelL, rmsInLevelR, rmsOutLevelL, rmsOutLevelR;
+    /** Only the chain matching getProcessingPrecision() is prepared and kept up to date */
+    std::tuple<ProcessingChain<float>, ProcessingChain<double>> chains;
     
-    juce::dsp::Gain<float> inputGain, outputGain;
+    ParameterSnapshot parameterSnapshot {apvts};
+    ParameterSnapshot::Values parameters;
     
 
     //==============================================================================
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Levels measured over one processed block. Plain data so it can be copied through the FIFO. */
+struct TelemetryFrame
+{
+    /** Enough for third order Ambisonics and 7.1.4 */
+    static constexpr int maxChannels = 16;
+
+    int numChannels = 0;
+    bool bypassed = false;
+
+    /** Linear peak and RMS per channel */
+    std::array<float, maxChannels> inputPeak {};
+    std::array<float, maxChannels> inputRms {};
+    std::array<float, maxChannels> outputPeak {};
+    std::array<float, maxChannels> outputRms {};
+
+    /** Deepest and average gain reduction in the block, in dB (0 or negative) */
+    std::array<float, maxChannels> gainReduction {};
+    std::array<float, maxChannels> averageGainReduction {};
+
+    std::array<bool, maxChannels> inputClip {};
+    std::array<bool, maxChannels> outputClip {};
+};
+
+/**
+    Wait-free single-producer/single-consumer ring of telemetry frames.
+
+    The audio thread pushes one frame per block and never blocks: if the editor
+    has fallen behind (or isn't open) the frame is simply dropped. The editor drains
+    everything that is ready from its timer and does the smoothing there.
+*/
+class TelemetryFifo
+{
+public:
+
+    static constexpr int capacity = 256;
+
+    /** Audio thread only. Returns false if the ring was full and the frame was dropped. */
+    bool push(const TelemetryFrame& frame) noexcept
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 > 0)
+        {
+            frames[static_cast<size_t>(scope.startIndex1)] = frame;
+            return true;
+        }
+
+        if (scope.blockSize2 > 0)
+        {
+            frames[static_cast<size_t>(scope.startIndex2)] = frame;
+            return true;
+        }
+
+        return false;
+    }
+
+    /** Message thread only. Calls handler for every frame that is ready, oldest first, and returns how many there were. */
+    template <typename Handler>
+    int drain(Handler&& handler)
+    {
+        const auto numReady = fifo.getNumReady();
+        const auto scope = fifo.read(numReady);
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+        {
+            handler(frames[static_cast<size_t>(scope.startIndex1 + i)]);
+        }
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+        {
+            handler(frames[static_cast<size_t>(scope.startIndex2 + i)]);
+        }
+
+        return numReady;
+    }
+
+private:
+
+    juce::AbstractFifo fifo {capacity};
+    std::array<TelemetryFrame, capacity> frames;
+};
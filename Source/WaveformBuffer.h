@@ -0,0 +1,168 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Lock-free, pre-decimated min/max history of the processed signal for the waveform view.
+
+    The audio thread reduces every samplesPerPoint samples (all channels) to one
+    min/max point on level 0. Each level above holds points twice as wide, built
+    from pairs of points on the level below, so the editor can pick the level that
+    matches its zoom and draw it without resampling. Every level is a ring whose
+    write index is published with release ordering; the editor only reads.
+
+    Nothing runs on the audio thread unless an editor has called setActive(true).
+*/
+class WaveformBuffer
+{
+public:
+
+    static constexpr int samplesPerPoint = 32;
+    static constexpr int numLevels = 6;
+    static constexpr int pointsPerLevel = 4096;
+
+    WaveformBuffer()
+    {
+        for (int level = 0; level < numLevels; ++level)
+        {
+            writeIndices[level].store(0);
+
+            for (int point = 0; point < pointsPerLevel; ++point)
+            {
+                minimums[level][point].store(0.f);
+                maximums[level][point].store(0.f);
+            }
+        }
+    }
+
+    /** Called by the editor when it opens and closes. */
+    void setActive(bool shouldBeActive) noexcept
+    {
+        active.store(shouldBeActive, std::memory_order_release);
+    }
+
+    bool isActive() const noexcept
+    {
+        return active.load(std::memory_order_acquire);
+    }
+
+    /** Audio thread only. Folds the block into the pending point and publishes every completed one. */
+    template <typename SampleType>
+    void push(const juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        auto position = 0;
+
+        while (position < numSamples)
+        {
+            const auto count = juce::jmin(numSamples - position, samplesPerPoint - pendingSamples);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, position), count);
+                pendingMin = juce::jmin(pendingMin, static_cast<float>(range.getStart()));
+                pendingMax = juce::jmax(pendingMax, static_cast<float>(range.getEnd()));
+            }
+
+            pendingSamples += count;
+            position += count;
+
+            if (pendingSamples == samplesPerPoint)
+            {
+                writePoint(0, pendingMin, pendingMax);
+
+                pendingSamples = 0;
+                pendingMin = std::numeric_limits<float>::max();
+                pendingMax = std::numeric_limits<float>::lowest();
+            }
+        }
+    }
+
+    /** Message thread. Copies up to numPoints of the newest points of a level into dest, oldest first, and returns how many were copied. */
+    int read(int level, juce::Range<float>* dest, int numPoints) const noexcept
+    {
+        jassert(juce::isPositiveAndBelow(level, numLevels));
+
+        const auto written = writeIndices[level].load(std::memory_order_acquire);
+
+        // Keep half the ring between the reader and the writer
+        numPoints = static_cast<int>(juce::jmin<juce::uint64>(static_cast<juce::uint64>(juce::jmax(0, numPoints)),
+                                                              written,
+                                                              pointsPerLevel / 2));
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto index = static_cast<int>((written - static_cast<juce::uint64>(numPoints - i)) & (pointsPerLevel - 1));
+            dest[i] = {minimums[level][index].load(std::memory_order_relaxed), maximums[level][index].load(std::memory_order_relaxed)};
+        }
+
+        return numPoints;
+    }
+
+    /** Returns the finest level whose points are no wider than samplesPerPixel. */
+    static int getLevelForZoom(double samplesPerPixel) noexcept
+    {
+        auto level = 0;
+
+        while (level < numLevels - 1 && getSamplesPerPoint(level + 1) <= samplesPerPixel)
+        {
+            ++level;
+        }
+
+        return level;
+    }
+
+    static int getSamplesPerPoint(int level) noexcept
+    {
+        return samplesPerPoint << level;
+    }
+
+private:
+
+    void writePoint(int level, float minimum, float maximum) noexcept
+    {
+        const auto written = writeIndices[level].load(std::memory_order_relaxed);
+        const auto index = static_cast<int>(written & (pointsPerLevel - 1));
+
+        minimums[level][index].store(minimum, std::memory_order_relaxed);
+        maximums[level][index].store(maximum, std::memory_order_relaxed);
+        writeIndices[level].store(written + 1, std::memory_order_release);
+
+        if (level + 1 == numLevels)
+        {
+            return;
+        }
+
+        // Every second point on this level completes one on the level above
+        auto& carry = carries[level];
+
+        if (! carry.pending)
+        {
+            carry = {minimum, maximum, true};
+            return;
+        }
+
+        carry.pending = false;
+        writePoint(level + 1, juce::jmin(carry.minimum, minimum), juce::jmax(carry.maximum, maximum));
+    }
+
+    struct Carry
+    {
+        float minimum = 0.f;
+        float maximum = 0.f;
+        bool pending = false;
+    };
+
+    std::atomic<bool> active {false};
+
+    std::array<std::array<std::atomic<float>, pointsPerLevel>, numLevels> minimums, maximums;
+    std::array<std::atomic<juce::uint64>, numLevels> writeIndices;
+
+    // Audio thread state
+    std::array<Carry, numLevels> carries;
+    int pendingSamples = 0;
+    float pendingMin = std::numeric_limits<float>::max();
+    float pendingMax = std::numeric_limits<float>::lowest();
+
+    JUCE_DECLARE_NON_COPYABLE(WaveformBuffer)
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformBuffer.h"
+
+/** Scrolling min/max waveform drawn straight from the processor's WaveformBuffer. */
+class WaveformView : public Component, private Timer
+{
+public:
+
+    explicit WaveformView(WaveformBuffer& bufferToDraw)
+    : waveform(bufferToDraw)
+    {
+        points.resize(WaveformBuffer::pointsPerLevel);
+        waveform.setActive(true);
+        startTimerHz(30);
+    }
+
+    ~WaveformView() override
+    {
+        waveform.setActive(false);
+    }
+
+    /** Same scale as the old AudioVisualiserComponent buffer size: the number of 256 sample blocks on screen. */
+    void setZoom(double numBlocks)
+    {
+        visibleSamples = numBlocks * 256.0;
+    }
+
+    void paint(Graphics& g) override
+    {
+        g.fillAll(Colours::darkgrey);
+
+        const auto width = getWidth();
+
+        if (width <= 0)
+        {
+            return;
+        }
+
+        // Pick the level whose points are closest to one per pixel, then draw them as they are
+        const auto samplesPerPixel = visibleSamples / width;
+        const auto level = WaveformBuffer::getLevelForZoom(samplesPerPixel);
+        const auto pixelsPerPoint = WaveformBuffer::getSamplesPerPoint(level) / samplesPerPixel;
+        const auto numPoints = waveform.read(level, points.data(), static_cast<int>(std::ceil(width / pixelsPerPoint)));
+
+        const auto height = static_cast<float>(getHeight());
+        const auto midline = height * 0.5f;
+
+        g.setColour(Colours::black);
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto x = width - static_cast<int>((numPoints - i) * pixelsPerPoint);
+            const auto top = midline - jlimit(-1.f, 1.f, points[i].getEnd()) * midline;
+            const auto bottom = midline - jlimit(-1.f, 1.f, points[i].getStart()) * midline;
+
+            g.drawVerticalLine(x, top, jmax(bottom, top + 1.f));
+        }
+    }
+
+private:
+
+    void timerCallback() override
+    {
+        repaint();
+    }
+
+    WaveformBuffer& waveform;
+    std::vector<Range<float>> points;
+    double visibleSamples = 256.0 * 256.0;
+};
@@ -0,0 +1,317 @@
+#include "Compressor.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+Compressor<SampleType>::Compressor()
+{
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    preparedSampleRate = spec.sampleRate;
+    expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+    maximumBlockSize = juce::jmax ((size_t) 1, (size_t) spec.maximumBlockSize);
+
+    // Channel 0 holds the envelope, channel 1 the level/gain, channels 2 and 3 the
+    // mid and side signals in kMidSide mode. All are SIMD aligned.
+    scratch = juce::dsp::AudioBlock<SampleType> (scratchData, 4, maximumBlockSize);
+    envelopeState.assign (spec.numChannels, static_cast<SampleType> (0.0));
+    gainStats.resize (spec.numChannels);
+    inputPointers.assign (spec.numChannels, nullptr);
+    detectorPointers.assign (juce::jmax (spec.numChannels, (juce::uint32) 2), nullptr);
+    outputPointers.assign (spec.numChannels, nullptr);
+
+    lookahead.prepare (spec, (int) std::ceil (maximumLookaheadMs * 0.001 * sampleRate));
+    setLookahead (lookaheadTime);
+
+    update();
+    reset();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setSampleRate (double newSampleRate)
+{
+    jassert (newSampleRate > 0 && newSampleRate <= preparedSampleRate);
+
+    sampleRate = newSampleRate;
+    expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+
+    setLookahead (lookaheadTime);
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::reset()
+{
+    std::fill (envelopeState.begin(), envelopeState.end(), static_cast<SampleType> (0.0));
+    resetGainStats();
+    lookahead.reset();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::resetGainStats() noexcept
+{
+    for (auto& stats : gainStats)
+    {
+        stats = {};
+        stats.minimum = static_cast<SampleType> (1.0);
+    }
+}
+
+template <typename SampleType>
+SampleType Compressor<SampleType>::processSample (int channel, SampleType inputValue)
+{
+    // Lookahead peak hold and audio delay
+    auto rectified = std::abs (inputValue);
+    lookahead.processPeakHold (channel, &rectified, 1);
+    lookahead.processDelay (channel, &inputValue, 1);
+
+    // Ballistics filter with peak rectifier
+    auto& env = envelopeState[(size_t) channel];
+    const auto cte = rectified > env ? cteAttack : cteRelease;
+    env = rectified + cte * (env - rectified);
+
+    // VCA
+    auto gain = (env < threshold) ? static_cast<SampleType> (1.0)
+                                  : std::pow (env * thresholdInverse, ratioInverse - static_cast<SampleType> (1.0));
+
+    // Output
+    return gain * inputValue;
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::processChannel (int channel, const SampleType* detector, const SampleType* input, SampleType* output, int numSamples) noexcept
+{
+    juce::FloatVectorOperations::abs (scratch.getChannelPointer (0), detector, numSamples);
+
+    computeGain (channel, numSamples);
+    accumulateGainStats (channel, LevelAnalyser<SampleType>::analyse (scratch.getChannelPointer (1), numSamples));
+    applyGain (channel, input, output, numSamples);
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::processLinked (int numChannels, int numDetectorChannels, int numSamples) noexcept
+{
+    auto* envelope = scratch.getChannelPointer (0);
+    auto* rectified = scratch.getChannelPointer (1);
+
+    // Loudest channel (or the mean) at every sample; the gain channel is free until computeGain()
+    juce::FloatVectorOperations::abs (envelope, detectorPointers[0], numSamples);
+
+    for (int channel = 1; channel < numDetectorChannels; ++channel)
+    {
+        juce::FloatVectorOperations::abs (rectified, detectorPointers[(size_t) channel], numSamples);
+
+        if (linkMode == LinkMode::kAverageLinked)
+            juce::FloatVectorOperations::add (envelope, rectified, numSamples);
+        else
+            juce::FloatVectorOperations::max (envelope, envelope, rectified, numSamples);
+    }
+
+    if (linkMode == LinkMode::kAverageLinked)
+        juce::FloatVectorOperations::multiply (envelope, static_cast<SampleType> (1.0) / static_cast<SampleType> (numDetectorChannels), numSamples);
+
+    // The shared detector keeps its state in channel 0
+    computeGain (0, numSamples);
+
+    const auto chunkStats = LevelAnalyser<SampleType>::analyse (scratch.getChannelPointer (1), numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        accumulateGainStats (channel, chunkStats);
+        applyGain (channel, inputPointers[(size_t) channel], outputPointers[(size_t) channel], numSamples);
+    }
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::processMidSide (int numDetectorChannels, int numSamples) noexcept
+{
+    auto* detector = scratch.getChannelPointer (0);
+    auto* mid  = scratch.getChannelPointer (2);
+    auto* side = scratch.getChannelPointer (3);
+
+    // Encode. Read both inputs before writing, since the outputs may alias them.
+    juce::FloatVectorOperations::add (mid, inputPointers[0], inputPointers[1], numSamples);
+    juce::FloatVectorOperations::multiply (mid, static_cast<SampleType> (0.5), numSamples);
+    juce::FloatVectorOperations::subtract (side, inputPointers[0], inputPointers[1], numSamples);
+    juce::FloatVectorOperations::multiply (side, static_cast<SampleType> (0.5), numSamples);
+
+    // A mono sidechain counts as L = R, so it only drives the mid
+    const auto* detectorLeft  = detectorPointers[0];
+    const auto* detectorRight = detectorPointers[numDetectorChannels > 1 ? 1 : 0];
+
+    // Mid runs on detector and delay channel 0, side on channel 1
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        auto* signal = channel == 0 ? mid : side;
+
+        if (channel == 0)
+            juce::FloatVectorOperations::add (detector, detectorLeft, detectorRight, numSamples);
+        else
+            juce::FloatVectorOperations::subtract (detector, detectorLeft, detectorRight, numSamples);
+
+        juce::FloatVectorOperations::multiply (detector, static_cast<SampleType> (0.5), numSamples);
+        juce::FloatVectorOperations::abs (detector, detector, numSamples);
+        computeGain (channel, numSamples);
+        accumulateGainStats (channel, LevelAnalyser<SampleType>::analyse (scratch.getChannelPointer (1), numSamples));
+        applyGain (channel, signal, signal, numSamples);
+    }
+
+    // Decode
+    juce::FloatVectorOperations::add (outputPointers[0], mid, side, numSamples);
+    juce::FloatVectorOperations::subtract (outputPointers[1], mid, side, numSamples);
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::computeGain (int detectorChannel, int numSamples) noexcept
+{
+    auto* envelope = scratch.getChannelPointer (0);
+    auto* gain     = scratch.getChannelPointer (1);
+
+    // Detector: hold the upcoming peak, then the attack/release recursion
+    lookahead.processPeakHold (detectorChannel, envelope, numSamples);
+
+    auto env = envelopeState[(size_t) detectorChannel];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto cte = envelope[i] > env ? cteAttack : cteRelease;
+        env = envelope[i] + cte * (env - envelope[i]);
+        envelope[i] = env;
+    }
+
+    envelopeState[(size_t) detectorChannel] = env;
+
+    // Level in log2 units
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (envelope[i])));
+
+    // Gain curve in log2 units
+    applyGainCurve (gain, numSamples);
+
+    // Linear gain
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain[i])));
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::applyGain (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+{
+    // Audio path is delayed by the same lookahead so it meets the held peak
+    if (output != input)
+        juce::FloatVectorOperations::copy (output, input, numSamples);
+
+    lookahead.processDelay (channel, output, numSamples);
+
+    // VCA
+    juce::FloatVectorOperations::multiply (output, scratch.getChannelPointer (1), numSamples);
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::accumulateGainStats (int channel, const BlockLevels<SampleType>& chunkStats) noexcept
+{
+    // Gain reduction statistics, accumulated over every chunk of the host block
+    auto& stats = gainStats[(size_t) channel];
+    stats.minimum = juce::jmin (stats.minimum, chunkStats.minimum);
+    stats.sum += chunkStats.sum;
+    stats.numSamples += chunkStats.numSamples;
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::applyGainCurve (SampleType* levels, int numSamples) const noexcept
+{
+    using SIMD = juce::dsp::SIMDRegister<SampleType>;
+
+    const auto simdSize = (int) SIMD::size();
+    const auto slope = ratioInverse - static_cast<SampleType> (1.0);
+
+    const auto thresholdRegister = SIMD::expand (thresholdLog2);
+    const auto slopeRegister     = SIMD::expand (slope);
+    const auto zeroRegister      = SIMD::expand (static_cast<SampleType> (0.0));
+
+    int i = 0;
+
+    // levels is the aligned scratch buffer, so every full register load is aligned
+    for (; i + simdSize <= numSamples; i += simdSize)
+    {
+        const auto level = SIMD::fromRawArray (levels + i);
+        SIMD::min (zeroRegister, (level - thresholdRegister) * slopeRegister).copyToRawArray (levels + i);
+    }
+
+    for (; i < numSamples; ++i)
+        levels[i] = juce::jmin (static_cast<SampleType> (0.0), (levels[i] - thresholdLog2) * slope);
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::update()
+{
+    threshold = juce::Decibels::decibelsToGain (thresholddB, static_cast<SampleType> (-200.0));
+    thresholdInverse = static_cast<SampleType> (1.0) / threshold;
+    thresholdLog2    = static_cast<SampleType> (std::log2 (threshold));
+    ratioInverse     = static_cast<SampleType> (1.0) / ratio;
+
+    // Same time constants as juce::dsp::BallisticsFilter
+    cteAttack  = attackTime  < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / attackTime));
+    cteRelease = releaseTime < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / releaseTime));
+}
+
+#pragma mark Setters
+template <typename SampleType>
+void Compressor<SampleType>::setThreshold (SampleType newThreshold)
+{
+    thresholddB = newThreshold;
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setRatio (SampleType newRatio)
+{
+    jassert (newRatio >= static_cast<SampleType> (1.0));
+
+    ratio = newRatio;
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setAttack (SampleType newAttack)
+{
+    attackTime = newAttack;
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setRelease (SampleType newRelease)
+{
+    releaseTime = newRelease;
+    update();
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setLookahead (SampleType newLookahead)
+{
+    jassert (newLookahead >= static_cast<SampleType> (0.0) && newLookahead <= static_cast<SampleType> (maximumLookaheadMs));
+
+    lookaheadTime = newLookahead;
+    lookahead.setDelay (juce::roundToInt (lookaheadTime * 0.001 * sampleRate));
+}
+
+template <typename SampleType>
+void Compressor<SampleType>::setLinkMode (LinkMode newLinkMode)
+{
+    linkMode = newLinkMode;
+}
+
+} // namespace viator_dsp
+
+template class viator_dsp::Compressor<float>;
+template class viator_dsp::Compressor<double>;
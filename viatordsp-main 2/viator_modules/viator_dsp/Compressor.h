@@ -0,0 +1,248 @@
+#ifndef Compressor_h
+#define Compressor_h
+
+#include "../Common/Common.h"
+#include "LookaheadDelay.h"
+#include "LevelAnalyser.h"
+
+namespace viator_dsp
+{
+
+/**
+    Feed-forward peak compressor with the same transfer curve and ballistics as
+    juce::dsp::Compressor, so it can be swapped in without retuning.
+
+    Instead of running envelope -> pow() per sample, each block goes through
+    separate passes over a scratch buffer:
+
+        rectify -> envelope -> log2 level -> gain curve -> linear gain -> apply
+
+    The log/exp passes use FastMath::fastLog2/fastExp2 and the gain curve runs on
+    juce::dsp::SIMDRegister, leaving the envelope recursion as the only scalar loop.
+    The resulting gain matches juce::dsp::Compressor to within 0.001 dB; the
+    Benchmarks target checks this with --accuracy.
+
+    An optional lookahead of up to maximumLookaheadMs delays the audio path and
+    lets the detector hold the upcoming peak, so the gain is already down when
+    a transient arrives. The delay is reported through getLatencySamples().
+
+    With LinkMode::kMaxLinked, process() folds every channel into one detector
+    (the loudest channel at each sample) and applies the single resulting gain
+    to all of them, so surround and Ambisonic beds keep their image. The detector
+    passes then run once per block whatever the channel count. Each extra channel
+    only adds vectorised rectify/max, delay and multiply passes, so the cost grows
+    smoothly up to 16 channels and beyond. kAverageLinked does the same with the
+    mean of the rectified channels, which reacts less to a single loud channel.
+
+    LinkMode::kMidSide encodes a stereo pair the way SVFilter does
+    (M = (L + R) / 2, S = (L - R) / 2), compresses M and S with their own
+    detectors and decodes back to L/R. The gain reduction for channel 0 then
+    reports the mid gain and channel 1 the side gain. Other channel counts fall
+    back to kMaxLinked.
+
+    The detector can listen to a separate sidechain block instead of the input.
+    It is read in place, so a host's sidechain bus needs no copy. Unlinked
+    channels pair with sidechain channels in turn. A sidechain with more
+    channels than the input is folded into one detector by the link mode
+    (max-linked when unlinked).
+*/
+template <typename SampleType>
+class Compressor
+{
+public:
+
+    /** How the detector treats multiple channels. */
+    enum class LinkMode
+    {
+        kUnlinked,
+        kMaxLinked,
+        kAverageLinked,
+        kMidSide
+    };
+
+    /** Constructor. */
+    Compressor();
+
+    /** Sets the threshold in dB of the compressor.*/
+    void setThreshold (SampleType newThreshold);
+
+    /** Sets the ratio of the compressor (must be higher or equal to 1).*/
+    void setRatio (SampleType newRatio);
+
+    /** Sets the attack time in milliseconds of the compressor.*/
+    void setAttack (SampleType newAttack);
+
+    /** Sets the release time in milliseconds of the compressor.*/
+    void setRelease (SampleType newRelease);
+
+    /** Sets the lookahead time in milliseconds, between 0 and maximumLookaheadMs.*/
+    void setLookahead (SampleType newLookahead);
+
+    /** Sets whether the channels share one detector. processSample() is always unlinked.*/
+    void setLinkMode (LinkMode newLinkMode);
+
+    /** Returns the latency added by the lookahead, in samples. */
+    int getLatencySamples() const noexcept { return lookahead.getDelay(); }
+
+    static constexpr double maximumLookaheadMs = 20.0;
+
+    /** Returns the deepest gain reduction applied to a channel during the last processed block, in dB. */
+    SampleType getGainReduction (int channel) const noexcept
+    {
+        return juce::Decibels::gainToDecibels (gainStats[(size_t) channel].minimum, static_cast<SampleType> (-200.0));
+    }
+
+    /** Returns the average gain reduction applied to a channel during the last processed block, in dB. */
+    SampleType getAverageGainReduction (int channel) const noexcept
+    {
+        const auto& stats = gainStats[(size_t) channel];
+
+        return stats.numSamples > 0 ? juce::Decibels::gainToDecibels (stats.getMean(), static_cast<SampleType> (-200.0))
+                                    : static_cast<SampleType> (0.0);
+    }
+
+    /** Initialises the processor. Allocates the scratch buffers, so call it off the audio thread. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /**
+        Retunes the ballistics and lookahead for a new rate without reallocating, e.g.
+        when an oversampling factor changes. The rate must not exceed the one passed
+        to prepare(), which sized the lookahead delay.
+    */
+    void setSampleRate (double newSampleRate);
+
+    /** Resets the internal state variables of the processor. */
+    void reset();
+
+    /** Processes the input and output samples supplied in the processing context. */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        process (context, context.getInputBlock());
+    }
+
+    /**
+        Processes the context with the detector listening to sidechain. The sidechain
+        must be at least as long as the context and have at most
+        max (numChannels, 2) channels.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context, const juce::dsp::AudioBlock<const SampleType>& sidechain) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples  = outputBlock.getNumSamples();
+        const auto numDetectorChannels = sidechain.getNumChannels();
+
+        jassert (inputBlock.getNumChannels() == numChannels);
+        jassert (inputBlock.getNumSamples()  == numSamples);
+        jassert (numChannels <= envelopeState.size());
+        jassert (numDetectorChannels > 0 && numDetectorChannels <= detectorPointers.size());
+        jassert (sidechain.getNumSamples() >= numSamples);
+
+        resetGainStats();
+
+        if (context.isBypassed)
+        {
+            // Still run the delay so the reported latency holds while bypassed
+            outputBlock.copyFrom (inputBlock);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                lookahead.processDelay ((int) channel, outputBlock.getChannelPointer (channel), (int) numSamples);
+
+            return;
+        }
+
+        // Hosts may send more than maximumBlockSize, so walk the block in scratch-sized chunks
+        for (size_t start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            const auto length = juce::jmin (maximumBlockSize, numSamples - start);
+
+            for (size_t channel = 0; channel < numDetectorChannels; ++channel)
+                detectorPointers[channel] = sidechain.getChannelPointer (channel) + start;
+
+            if (numDetectorChannels > numChannels || (linkMode != LinkMode::kUnlinked && numChannels > 1))
+            {
+                for (size_t channel = 0; channel < numChannels; ++channel)
+                {
+                    inputPointers[channel]  = inputBlock.getChannelPointer (channel) + start;
+                    outputPointers[channel] = outputBlock.getChannelPointer (channel) + start;
+                }
+
+                if (linkMode == LinkMode::kMidSide && numChannels == 2)
+                    processMidSide ((int) numDetectorChannels, (int) length);
+                else
+                    processLinked ((int) numChannels, (int) numDetectorChannels, (int) length);
+
+                continue;
+            }
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                processChannel ((int) channel,
+                                detectorPointers[channel % numDetectorChannels],
+                                inputBlock.getChannelPointer (channel) + start,
+                                outputBlock.getChannelPointer (channel) + start,
+                                (int) length);
+            }
+        }
+    }
+
+    /** Performs the processing operation on a single sample at a time. */
+    SampleType processSample (int channel, SampleType inputValue);
+
+private:
+    void update();
+
+    /** Runs every pass for one channel. input and output may alias, and detector may be either. */
+    void processChannel (int channel, const SampleType* detector, const SampleType* input, SampleType* output, int numSamples) noexcept;
+
+    /** Runs one shared detector over detectorPointers and applies its gain to every channel. */
+    void processLinked (int numChannels, int numDetectorChannels, int numSamples) noexcept;
+
+    /** Compresses the mid and side of the stereo pair in inputPointers, detected from the M/S of detectorPointers. */
+    void processMidSide (int numDetectorChannels, int numSamples) noexcept;
+
+    /** Turns the rectified detector signal in scratch channel 0 into a linear gain in scratch channel 1. */
+    void computeGain (int detectorChannel, int numSamples) noexcept;
+
+    /** Delays the audio path and multiplies it by the gain in scratch channel 1. */
+    void applyGain (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept;
+
+    void accumulateGainStats (int channel, const BlockLevels<SampleType>& chunkStats) noexcept;
+
+    void resetGainStats() noexcept;
+
+    /** Turns log2 levels into log2 gains in place. */
+    void applyGainCurve (SampleType* levels, int numSamples) const noexcept;
+
+private:
+    juce::HeapBlock<char> scratchData;
+    juce::dsp::AudioBlock<SampleType> scratch;
+    size_t maximumBlockSize = 0;
+
+    std::vector<SampleType> envelopeState;
+    std::vector<BlockLevels<SampleType>> gainStats;
+
+    /** Chunk pointers, sized in prepare() */
+    std::vector<const SampleType*> inputPointers, detectorPointers;
+    std::vector<SampleType*> outputPointers;
+
+    LinkMode linkMode = LinkMode::kUnlinked;
+
+    LookaheadDelay<SampleType> lookahead;
+
+private:
+    SampleType threshold, thresholdInverse, thresholdLog2, ratioInverse, cteAttack, cteRelease;
+
+    double sampleRate = 44100.0;
+    double preparedSampleRate = 44100.0;
+    double expFactor = 0.0;
+
+    SampleType thresholddB = 0.0, ratio = 1.0, attackTime = 1.0, releaseTime = 100.0, lookaheadTime = 0.0;
+};
+
+} // namespace viator_dsp
+
+#endif /* Compressor_h */
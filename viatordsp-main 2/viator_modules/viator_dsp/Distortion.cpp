@@ -28,6 +28,15 @@ void viator_dsp::Distortion<SampleType>::prepare(const juce::dsp::ProcessSpec& s
     _dcFilter.setType(juce::dsp::LinkwitzRileyFilter<float>::Type::highpass);
     _dcFilter.setCutoffFrequency(10.0);
     
+    _ramps.setSize(kNumRamps, juce::jmax(1, static_cast<int>(spec.maximumBlockSize)));
+    _antiAliasingStates.resize(spec.numChannels * maxAntiAliasingStages);
+    _antiAliasingScratch.setSize(kNumAntiAliasingRows, _ramps.getNumSamples() + 2);
+    
+    if constexpr (!std::is_same<SampleType, float>::value)
+    {
+        _conversionBlock = juce::dsp::AudioBlock<SampleType>(_conversionData, spec.numChannels, static_cast<size_t>(_ramps.getNumSamples()));
+    }
+    
     reset();
 }
 
@@ -48,6 +57,8 @@ void viator_dsp::Distortion<SampleType>::reset() noexcept
         _mix.setTargetValue(1.0);
         _output.reset(_currentSampleRate, 0.02);
         _output.setTargetValue(0.0);
+        
+        std::fill(_antiAliasingStates.begin(), _antiAliasingStates.end(), AntiAliasingState());
     }
 }
 
@@ -106,5 +117,868 @@ void viator_dsp::Distortion<SampleType>::setClipperType(ClipType clipType)
     }
 }
 
+template <typename SampleType>
+void viator_dsp::Distortion<SampleType>::setAntiAliasing(AntiAliasing newAntiAliasing)
+{
+    // The saved antiderivatives belong to the old order
+    if (_antiAliasing != newAntiAliasing)
+    {
+        _antiAliasing = newAntiAliasing;
+        std::fill(_antiAliasingStates.begin(), _antiAliasingStates.end(), AntiAliasingState());
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::Distortion<SampleType>::processBlock(const juce::dsp::AudioBlock<const SampleType>& input, const juce::dsp::AudioBlock<SampleType>& output) noexcept
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numSamples = static_cast<int>(input.getNumSamples());
+    
+    // Called before prepare(), the ramps are empty and the loop below would never advance
+    jassert(_ramps.getNumSamples() > 0);
+    
+    if (_ramps.getNumSamples() == 0)
+    {
+        return;
+    }
+    
+    // Longer blocks than prepare() was told about run in ramp-sized pieces
+    for (int start = 0; start < numSamples; start += _ramps.getNumSamples())
+    {
+        const auto length = juce::jmin(_ramps.getNumSamples(), numSamples - start);
+        
+        fillRamps(length);
+        
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* in = input.getChannelPointer(channel) + start;
+            auto* out = output.getChannelPointer(channel) + start;
+            const auto ch = static_cast<int>(channel);
+            
+            switch (m_clipType)
+            {
+                case ClipType::kHard: processChannel<ClipType::kHard>(in, out, length, ch); break;
+                case ClipType::kSoft: processChannel<ClipType::kSoft>(in, out, length, ch); break;
+                case ClipType::kFuzz: processChannel<ClipType::kFuzz>(in, out, length, ch); break;
+                case ClipType::kTube: processChannel<ClipType::kTube>(in, out, length, ch); break;
+                case ClipType::kSaturation: processChannel<ClipType::kSaturation>(in, out, length, ch); break;
+                case ClipType::kLofi: processChannel<ClipType::kLofi>(in, out, length, ch); break;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::Distortion<SampleType>::processBuffer(juce::AudioBuffer<float>& buffer) noexcept
+{
+    juce::dsp::AudioBlock<float> block(buffer);
+    
+    if constexpr (std::is_same<SampleType, float>::value)
+    {
+        processBlock(block, block);
+    }
+    
+    else
+    {
+        jassert(block.getNumChannels() <= _conversionBlock.getNumChannels());
+        
+        const auto numChannels = block.getNumChannels();
+        const auto maxLength = _conversionBlock.getNumSamples();
+        
+        for (size_t start = 0; start < block.getNumSamples(); start += maxLength)
+        {
+            const auto length = juce::jmin(maxLength, block.getNumSamples() - start);
+            auto scratch = _conversionBlock.getSubsetChannelBlock(0, numChannels).getSubBlock(0, length);
+            
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* source = block.getChannelPointer(channel) + start;
+                auto* destination = scratch.getChannelPointer(channel);
+                
+                for (size_t i = 0; i < length; ++i)
+                    destination[i] = static_cast<SampleType>(source[i]);
+            }
+            
+            processBlock(scratch, scratch);
+            
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* source = scratch.getChannelPointer(channel);
+                auto* destination = block.getChannelPointer(channel) + start;
+                
+                for (size_t i = 0; i < length; ++i)
+                    destination[i] = static_cast<float>(source[i]);
+            }
+        }
+    }
+    
+    // A separate pass, so the filter's recursion stays in one channel's state for the whole block
+    _dcFilter.process(juce::dsp::ProcessContextReplacing<float>(block));
+}
+
+template <typename SampleType>
+void viator_dsp::Distortion<SampleType>::fillRamps(int numSamples) noexcept
+{
+    fillRamp(_rawGain, kDriveRamp, numSamples);
+    fillRamp(_thresh, kThreshRamp, numSamples);
+    fillRamp(_ceiling, kCeilingRamp, numSamples);
+    fillRamp(_mix, kMixRamp, numSamples);
+    
+    const auto outputRamping = fillRamp(_output, kOutputRamp, numSamples);
+    fillDecibelRamp(kOutputRamp, kOutputRamp, 1.0, outputRamping, numSamples);
+    
+    // Same curves as processSample(): saturation compensates the whole drive, the rest half of it
+    const auto gainRamping = fillRamp(_gainDB, kGainRamp, numSamples);
+    fillDecibelRamp(kGainRamp, kCompensationRamp, m_clipType == ClipType::kSaturation ? -1.0 : -0.5, gainRamping, numSamples);
+    
+    if (m_clipType == ClipType::kTube || m_clipType == ClipType::kFuzz)
+    {
+        fillDecibelRamp(kGainRamp, kPostGainRamp, -0.25, gainRamping, numSamples);
+    }
+    
+    else if (m_clipType == ClipType::kLofi)
+    {
+        fillDecibelRamp(kGainRamp, kPostGainRamp, 0.25, gainRamping, numSamples);
+    }
+}
+
+template <typename SampleType>
+bool viator_dsp::Distortion<SampleType>::fillRamp(juce::SmoothedValue<float>& value, int ramp, int numSamples) noexcept
+{
+    auto* destination = _ramps.getWritePointer(ramp);
+    
+    if (!value.isSmoothing())
+    {
+        juce::FloatVectorOperations::fill(destination, static_cast<SampleType>(value.getTargetValue()), numSamples);
+        return false;
+    }
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        destination[i] = value.getNextValue();
+    }
+    
+    return true;
+}
+
+template <typename SampleType>
+void viator_dsp::Distortion<SampleType>::fillDecibelRamp(int source, int destination, SampleType scale, bool isRamping, int numSamples) noexcept
+{
+    const auto* decibels = _ramps.getReadPointer(source);
+    auto* gains = _ramps.getWritePointer(destination);
+    
+    if (!isRamping)
+    {
+        juce::FloatVectorOperations::fill(gains, juce::Decibels::decibelsToGain(decibels[0] * scale), numSamples);
+        return;
+    }
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        gains[i] = juce::Decibels::decibelsToGain(decibels[i] * scale);
+    }
+}
+
+template <typename SampleType>
+forcedinline SampleType viator_dsp::Distortion<SampleType>::atanApprox(SampleType x) noexcept
+{
+    // Odd minimax polynomial on [0, 1]; above 1, atan(a) = pi / 2 - atan(1 / a)
+    const auto a = std::abs(x);
+    const auto z = juce::jmin(a, static_cast<SampleType>(1.0) / a);
+    const auto z2 = z * z;
+    
+    const auto p = z * (static_cast<SampleType>(0.999996111639775)
+                 + z2 * (static_cast<SampleType>(-0.333173682503489)
+                 + z2 * (static_cast<SampleType>(0.198078169311482)
+                 + z2 * (static_cast<SampleType>(-0.132333463104235)
+                 + z2 * (static_cast<SampleType>(0.079623735334663)
+                 + z2 * (static_cast<SampleType>(-0.033604264743633)
+                 + z2 * static_cast<SampleType>(0.006811804776237)))))));
+    
+    // The sign of a - 1 picks p or pi / 2 - p without a compare, which would stop the kernels vectorising
+    const auto quarterPi = juce::MathConstants<SampleType>::halfPi * static_cast<SampleType>(0.5);
+    const auto side = std::copysign(static_cast<SampleType>(1.0), a - 1);
+    
+    return std::copysign(quarterPi + side * (quarterPi - p), x);
+}
+
+template <typename SampleType>
+inline double viator_dsp::Distortion<SampleType>::preciseAtan(double x) noexcept
+{
+    // Two divisions bring |x| within tan(pi / 8) without a compare, which would stop the antiderivative passes vectorising:
+    // atan(a) = pi / 4 + atan(v) with v = (a - 1) / (a + 1) in [-1, 1), then atan(|v|) = pi / 8 + atan((|v| - t) / (1 + t |v|))
+    constexpr auto t = 0.41421356237309503; // tan (pi / 8)
+    
+    const auto a = std::abs(x);
+    const auto v = (a - 1.0) / (a + 1.0);
+    const auto w = (std::abs(v) - t) / (1.0 + t * std::abs(v));
+    const auto w2 = w * w;
+    
+    // Least squares fit of atan(w) / w in w^2, within 5e-15 of atan(w)
+    const auto p = w * (0.99999999999976252
+                 + w2 * (-0.33333333324946579
+                 + w2 * (0.19999999129739382
+                 + w2 * (-0.14285673097276394
+                 + w2 * (0.11110049724120129
+                 + w2 * (-0.090747085138858249
+                 + w2 * (0.075406470421694155
+                 + w2 * (-0.057978999539777781
+                 + w2 * 0.029614080124018498))))))));
+    
+    constexpr auto quarterPi = juce::MathConstants<double>::pi * 0.25;
+    return std::copysign(quarterPi + std::copysign(quarterPi * 0.5 + p, v), x);
+}
+
+template <typename SampleType>
+inline double viator_dsp::Distortion<SampleType>::preciseLog1p(double x) noexcept
+{
+    jassert(x >= 0.0);
+    
+    // 1 + x = 2^exponent * m with m in [sqrt(1/2), sqrt(2)). Forming 1 + x costs at most 1e-16 absolute, which is all the antiderivatives need.
+    const auto y = 1.0 + x;
+    uint64_t bits;
+    std::memcpy(&bits, &y, sizeof(bits));
+    
+    // The split is done on the bits, as musl's log does, so there's no compare: adding 1 - sqrt(1/2)'s
+    // mantissa carries into the exponent exactly when m would be sqrt(2) or more
+    constexpr uint64_t sqrtHalfBits = 0x3fe6a09e667f3bcdull;
+    bits += 0x3ff0000000000000ull - sqrtHalfBits;
+    
+    // The biased exponent goes into the mantissa of 2^52, which turns it into a double without an integer conversion
+    uint64_t exponentBits = (bits >> 52) | 0x4330000000000000ull;
+    bits = (bits & 0x000fffffffffffffull) + sqrtHalfBits;
+    
+    double exponent, m;
+    std::memcpy(&exponent, &exponentBits, sizeof(exponent));
+    std::memcpy(&m, &bits, sizeof(m));
+    exponent -= 4503599627370496.0 + 1023.0; // 2^52 and the bias
+    
+    // log(m) = log((1 + s) / (1 - s)), least squares fit in s^2, within 5e-15
+    const auto s = (m - 1.0) / (m + 1.0);
+    const auto s2 = s * s;
+    
+    const auto p = s * (1.9999999999996541
+                 + s2 * (0.66666666699648225
+                 + s2 * (0.39999991069555402
+                 + s2 * (0.28572463244844987
+                 + s2 * (0.22164148669002082
+                 + s2 * 0.19732962595192347)))));
+    
+    return exponent * 0.69314718055994531 + p; // ln(2)
+}
+
+template <typename SampleType>
+forcedinline SampleType viator_dsp::Distortion<SampleType>::tubeSample(SampleType input, SampleType drive, SampleType ceiling, SampleType compensation, SampleType postGain, SampleType mix) noexcept
+{
+    // Drive goes on twice, once here and once inside the hard and soft clippers
+    const auto driven = input * drive;
+    
+    // Each half only sees its own side of zero, where the other one is zero, so adding them picks without a compare
+    const auto clipped = juce::jmin(juce::jmax(driven, static_cast<SampleType>(0.0)) * drive, ceiling) * compensation;
+    const auto saturated = _piDivisor * atanApprox(juce::jmin(driven, static_cast<SampleType>(0.0)) * drive) * static_cast<SampleType>(2.0) * compensation;
+    
+    const auto wet = (clipped + saturated) * mix + driven * (1 - mix);
+    
+    return wet * postGain;
+}
+
+template <typename SampleType>
+template <typename viator_dsp::Distortion<SampleType>::ClipType type>
+void viator_dsp::Distortion<SampleType>::processKernel(const SampleType* input, SampleType* output, int numSamples, int channel) noexcept
+{
+    const auto* drive = _ramps.getReadPointer(kDriveRamp);
+    const auto* thresh = _ramps.getReadPointer(kThreshRamp);
+    const auto* ceiling = _ramps.getReadPointer(kCeilingRamp);
+    const auto* mix = _ramps.getReadPointer(kMixRamp);
+    const auto* outputGain = _ramps.getReadPointer(kOutputRamp);
+    const auto* gainDB = _ramps.getReadPointer(kGainRamp);
+    const auto* compensation = _ramps.getReadPointer(kCompensationRamp);
+    const auto* postGain = _ramps.getReadPointer(kPostGainRamp);
+    
+    const auto two = static_cast<SampleType>(2.0);
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = input[i];
+        const auto dry = 1 - mix[i];
+        SampleType wet;
+        
+        if constexpr (type == ClipType::kHard)
+        {
+            wet = juce::jmin(juce::jmax(x * drive[i], -ceiling[i]), ceiling[i]) * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kSoft)
+        {
+            wet = _piDivisor * atanApprox(x * drive[i]) * two * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kTube)
+        {
+            wet = tubeSample(x, drive[i], ceiling[i], compensation[i], postGain[i], mix[i]);
+        }
+        
+        else if constexpr (type == ClipType::kFuzz)
+        {
+            const auto fuzz = x * dry + tubeSample(x, drive[i], ceiling[i], compensation[i], postGain[i], mix[i]) * mix[i];
+            const auto filtered = static_cast<SampleType>(m_fuzzFilter.processSample(static_cast<float>(fuzz), channel));
+            const auto saturated = _piDivisor * atanApprox(filtered * drive[i]) * two * compensation[i];
+            
+            wet = (filtered * dry + saturated * mix[i]) * static_cast<SampleType>(0.5);
+        }
+        
+        else if constexpr (type == ClipType::kSaturation)
+        {
+            const auto bias = static_cast<SampleType>(0.15);
+            const auto t = thresh[i];
+            const auto driven = x * (drive[i] + bias);
+            
+            // The knee runs on the input held at t or above, where it's t at t, and what's below t goes back on linearly
+            const auto above = juce::jmax(driven, t);
+            const auto over = (above - static_cast<SampleType>(0.5)) / t;
+            const auto knee = t + (above - t) / (1 + over * over) + juce::jmin(driven - t, static_cast<SampleType>(0.0));
+            const auto shaped = knee * static_cast<SampleType>(1.5) * compensation[i] - bias;
+            
+            wet = shaped * dry + _piDivisor * atanApprox(shaped) * mix[i];
+        }
+        
+        else if constexpr (type == ClipType::kLofi)
+        {
+            // jmap(gain, 0, 20, 1, -1) on the negative half only
+            const auto folded = x < 0 ? x * (1 - gainDB[i] * static_cast<SampleType>(0.1)) : x;
+            const auto saturated = (folded * dry + _piDivisor * atanApprox(folded) * mix[i]) * postGain[i];
+            const auto filtered = static_cast<SampleType>(m_lofiFilter.processSample(static_cast<float>(saturated), channel));
+            const auto clipped = juce::jmin(juce::jmax(filtered, -ceiling[i]), ceiling[i]) * compensation[i];
+            
+            wet = filtered * dry + clipped * mix[i];
+        }
+        
+        output[i] = (x * dry + wet * mix[i]) * outputGain[i];
+    }
+}
+
+template <typename SampleType>
+template <typename viator_dsp::Distortion<SampleType>::ClipType type>
+void viator_dsp::Distortion<SampleType>::processChannel(const SampleType* input, SampleType* output, int numSamples, int channel) noexcept
+{
+    // The fuzz and lofi filters sit between their clippers, so there's no single curve to integrate
+    if constexpr (type == ClipType::kFuzz || type == ClipType::kLofi)
+    {
+        processKernel<type>(input, output, numSamples, channel);
+    }
+    
+    else
+    {
+        switch (_antiAliasing)
+        {
+            case AntiAliasing::kNone: processKernel<type>(input, output, numSamples, channel); break;
+            case AntiAliasing::kFirstOrder: processAntiAliasedKernel<type, 1>(input, output, numSamples, channel); break;
+            case AntiAliasing::kSecondOrder: processAntiAliasedKernel<type, 2>(input, output, numSamples, channel); break;
+        }
+    }
+}
+
+/*
+    Each shape gives the curve, its antiderivative and its second
+    antiderivative, all zero at zero. The antiderivatives work in double: they
+    grow with the square and cube of the drive, and antiAlias() divides their
+    differences by the input's step, which float can't resolve. They use
+    preciseAtan() and preciseLog1p(), whose error is smooth and far below
+    anything the division can bring out. The curves themselves are only used
+    for the midpoint fallbacks, which are well conditioned, so the soft curve
+    is the same float atanApprox() the plain kernels use.
+    
+    The antiderivatives have no compares: with GCC's default -ftrapping-math a
+    select on doubles keeps antiAliasBlock()'s passes from vectorising.
+    Piecewise shapes are split with over(), max(x - edge, 0) as
+    (d + |d|) / 2, which is exactly 0 below the edge.
+*/
+
+/** Clamp to +-ceiling */
+template <typename SampleType>
+struct viator_dsp::Distortion<SampleType>::HardShape
+{
+    double ceiling;
+    
+    /** How far |x| is over the ceiling, or 0 */
+    double over(double x) const noexcept
+    {
+        const auto d = std::abs(x) - ceiling;
+        return 0.5 * (d + std::abs(d));
+    }
+    
+    double value(double x) const noexcept
+    {
+        return std::copysign(std::abs(x) - over(x), x);
+    }
+    
+    double antiderivative1(double x) const noexcept
+    {
+        const auto r = over(x);
+        const auto m = std::abs(x) - r;
+        return 0.5 * m * m + m * r;
+    }
+    
+    double antiderivative2(double x) const noexcept
+    {
+        const auto r = over(x);
+        const auto m = std::abs(x) - r;
+        return std::copysign(m * m * m / 6.0 + 0.5 * m * m * r + 0.5 * m * r * r, x);
+    }
+};
+
+/** 2 / pi * atan(x) */
+template <typename SampleType>
+struct viator_dsp::Distortion<SampleType>::SoftShape
+{
+    static constexpr double scale = 2.0 / juce::MathConstants<double>::pi;
+    
+    double value(double x) const noexcept
+    {
+        return scale * static_cast<double>(atanApprox(static_cast<SampleType>(x)));
+    }
+    
+    double antiderivative1(double x) const noexcept
+    {
+        return scale * (x * preciseAtan(x) - 0.5 * preciseLog1p(x * x));
+    }
+    
+    double antiderivative2(double x) const noexcept
+    {
+        return scale * (0.5 * (x * x - 1.0) * preciseAtan(x) + 0.5 * x - 0.5 * x * preciseLog1p(x * x));
+    }
+};
+
+/** Hard clip above zero, twice the soft curve below. Both are zero at zero, so each is fed its own half of x and the results added. */
+template <typename SampleType>
+struct viator_dsp::Distortion<SampleType>::TubeShape
+{
+    HardShape hard;
+    SoftShape soft;
+    
+    static double positive(double x) noexcept { return 0.5 * (x + std::abs(x)); }
+    static double negative(double x) noexcept { return 0.5 * (x - std::abs(x)); }
+    
+    double value(double x) const noexcept
+    {
+        return hard.value(positive(x)) + 2.0 * soft.value(negative(x));
+    }
+    
+    double antiderivative1(double x) const noexcept
+    {
+        return hard.antiderivative1(positive(x)) + 2.0 * soft.antiderivative1(negative(x));
+    }
+    
+    double antiderivative2(double x) const noexcept
+    {
+        return hard.antiderivative2(positive(x)) + 2.0 * soft.antiderivative2(negative(x));
+    }
+};
+
+/**
+    processSaturation()'s knee: linear up to thresh, then
+    thresh + (x - thresh) / (1 + y^2) with y = (x - 0.5) / thresh.
+    Above thresh the antiderivatives come from substituting y, which leaves
+    only log(1 + y^2) and atan(y) terms. Their values at thresh are worked out
+    once, when the shape is built. Below thresh over() is 0, the upper terms
+    cancel exactly and only the linear part's are left.
+*/
+template <typename SampleType>
+struct viator_dsp::Distortion<SampleType>::KneeShape
+{
+    explicit KneeShape(double threshold) noexcept
+    : thresh(threshold), primitiveAtThresh(primitive(threshold)), secondPrimitiveAtThresh(secondPrimitive(threshold))
+    {
+    }
+    
+    double thresh, primitiveAtThresh, secondPrimitiveAtThresh;
+    
+    /** How far x is over thresh, or 0 */
+    double over(double x) const noexcept
+    {
+        const auto d = x - thresh;
+        return 0.5 * (d + std::abs(d));
+    }
+    
+    double value(double x) const noexcept
+    {
+        const auto r = over(x);
+        const auto y = (thresh + r - 0.5) / thresh;
+        return x - r + r / (1.0 + y * y);
+    }
+    
+    double antiderivative1(double x) const noexcept
+    {
+        const auto r = over(x);
+        const auto linear = x - r;
+        
+        return 0.5 * linear * linear + primitive(thresh + r) - primitiveAtThresh;
+    }
+    
+    double antiderivative2(double x) const noexcept
+    {
+        const auto r = over(x);
+        const auto linear = x - r;
+        
+        return linear * linear * linear / 6.0 + secondPrimitive(thresh + r) - secondPrimitiveAtThresh
+               + (0.5 * thresh * thresh - primitiveAtThresh) * r;
+    }
+    
+    /** An antiderivative of the upper segment */
+    double primitive(double x) const noexcept
+    {
+        const auto y = (x - 0.5) / thresh;
+        return thresh * x + 0.5 * thresh * thresh * preciseLog1p(y * y) + thresh * (0.5 - thresh) * preciseAtan(y);
+    }
+    
+    /** An antiderivative of primitive() */
+    double secondPrimitive(double x) const noexcept
+    {
+        const auto y = (x - 0.5) / thresh;
+        const auto logTerm = preciseLog1p(y * y);
+        const auto atanTerm = preciseAtan(y);
+        
+        return 0.5 * thresh * x * x
+               + 0.5 * thresh * thresh * thresh * (y * logTerm - 2.0 * y + 2.0 * atanTerm)
+               + thresh * thresh * (0.5 - thresh) * (y * atanTerm - 0.5 * logTerm);
+    }
+};
+
+template <typename SampleType>
+template <int order, typename Shape>
+double viator_dsp::Distortion<SampleType>::antiAlias(const Shape& shape, double x, AntiAliasingState& state) noexcept
+{
+    // Below these steps the differences lose more to rounding than the midpoint fallback loses to curvature
+    constexpr auto tolerance = order == 1 ? 1.0e-5 : 1.0e-3;
+    
+    if constexpr (order == 1)
+    {
+        const auto antiderivative = shape.antiderivative1(x);
+        const auto step = x - state.x1;
+        const auto y = std::abs(step) < tolerance ? shape.value(0.5 * (x + state.x1))
+                                                  : (antiderivative - state.antiderivative) / step;
+        
+        state.x1 = x;
+        state.antiderivative = antiderivative;
+        return y;
+    }
+    
+    else
+    {
+        const auto antiderivative = shape.antiderivative2(x);
+        const auto step = x - state.x1;
+        const auto difference = std::abs(step) < tolerance ? shape.antiderivative1(0.5 * (x + state.x1))
+                                                           : (antiderivative - state.antiderivative) / step;
+        const auto span = x - state.x2;
+        auto y = 0.0;
+        
+        if (std::abs(span) >= tolerance)
+        {
+            y = 2.0 * (difference - state.difference) / span;
+        }
+        
+        // x came back to where it was two samples ago: expand around the middle one instead
+        else
+        {
+            const auto centre = 0.5 * (x + state.x2);
+            const auto offset = centre - state.x1;
+            
+            y = std::abs(offset) < tolerance ? shape.value(0.5 * (centre + state.x1))
+                                             : 2.0 / offset * (shape.antiderivative1(centre) + (state.antiderivative - shape.antiderivative2(centre)) / offset);
+        }
+        
+        state.x2 = state.x1;
+        state.x1 = x;
+        state.antiderivative = antiderivative;
+        state.difference = difference;
+        return y;
+    }
+}
+
+template <typename SampleType>
+template <int order, typename Shape>
+void viator_dsp::Distortion<SampleType>::antiAliasBlock(const Shape& shape, int numSamples, AntiAliasingState& state) noexcept
+{
+    constexpr auto tolerance = order == 1 ? 1.0e-5 : 1.0e-3;
+    
+    // The history goes in front of each row, so every sample's predecessors are at i - 1 and i - 2
+    auto* x = _antiAliasingScratch.getWritePointer(kCurveInput) + 2;
+    auto* antiderivative = _antiAliasingScratch.getWritePointer(kAntiderivative) + 1;
+    auto* difference = _antiAliasingScratch.getWritePointer(kDifference) + 1;
+    auto* y = _antiAliasingScratch.getWritePointer(kCurveOutput);
+    
+    x[-2] = state.x2;
+    x[-1] = state.x1;
+    antiderivative[-1] = state.antiderivative;
+    difference[-1] = state.difference;
+    
+    // The divisions run unguarded so the passes vectorise, and the few steps too small to divide by are patched afterwards.
+    // Scanning for them costs as much as a pass, so the passes flag them: |step| - tolerance, taken on the bits, only
+    // wraps into the top bit when |step| is the smaller.
+    const auto toleranceValue = tolerance;
+    uint64_t toleranceBits;
+    std::memcpy(&toleranceBits, &toleranceValue, sizeof(toleranceBits));
+    
+    const auto belowTolerance = [toleranceBits](double step) noexcept
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &step, sizeof(bits));
+        return (bits & 0x7fffffffffffffffull) - toleranceBits;
+    };
+    
+    uint64_t smallSteps = 0;
+    
+    if constexpr (order == 1)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            antiderivative[i] = shape.antiderivative1(x[i]);
+        }
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto step = x[i] - x[i - 1];
+            smallSteps |= belowTolerance(step);
+            y[i] = (antiderivative[i] - antiderivative[i - 1]) / step;
+        }
+        
+        for (int i = 0; (smallSteps >> 63) != 0 && i < numSamples; ++i)
+        {
+            if (std::abs(x[i] - x[i - 1]) < tolerance)
+            {
+                y[i] = shape.value(0.5 * (x[i] + x[i - 1]));
+            }
+        }
+        
+        state.x1 = x[numSamples - 1];
+        state.antiderivative = antiderivative[numSamples - 1];
+    }
+    
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            antiderivative[i] = shape.antiderivative2(x[i]);
+        }
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto step = x[i] - x[i - 1];
+            smallSteps |= belowTolerance(step);
+            difference[i] = (antiderivative[i] - antiderivative[i - 1]) / step;
+        }
+        
+        for (int i = 0; (smallSteps >> 63) != 0 && i < numSamples; ++i)
+        {
+            if (std::abs(x[i] - x[i - 1]) < tolerance)
+            {
+                difference[i] = shape.antiderivative1(0.5 * (x[i] + x[i - 1]));
+            }
+        }
+        
+        uint64_t smallSpans = 0;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto span = x[i] - x[i - 2];
+            smallSpans |= belowTolerance(span);
+            y[i] = 2.0 * (difference[i] - difference[i - 1]) / span;
+        }
+        
+        // Same expansion around the middle sample as antiAlias()
+        for (int i = 0; (smallSpans >> 63) != 0 && i < numSamples; ++i)
+        {
+            if (std::abs(x[i] - x[i - 2]) < tolerance)
+            {
+                const auto centre = 0.5 * (x[i] + x[i - 2]);
+                const auto offset = centre - x[i - 1];
+                
+                y[i] = std::abs(offset) < tolerance ? shape.value(0.5 * (centre + x[i - 1]))
+                                                    : 2.0 / offset * (shape.antiderivative1(centre) + (antiderivative[i - 1] - shape.antiderivative2(centre)) / offset);
+            }
+        }
+        
+        state.x2 = x[numSamples - 2];
+        state.x1 = x[numSamples - 1];
+        state.antiderivative = antiderivative[numSamples - 1];
+        state.difference = difference[numSamples - 1];
+    }
+}
+
+template <typename SampleType>
+template <typename viator_dsp::Distortion<SampleType>::ClipType type, int order>
+void viator_dsp::Distortion<SampleType>::processAntiAliasedKernel(const SampleType* input, SampleType* output, int numSamples, int channel) noexcept
+{
+    jassert(static_cast<size_t>((channel + 1) * maxAntiAliasingStages) <= _antiAliasingStates.size());
+    
+    const auto* drive = _ramps.getReadPointer(kDriveRamp);
+    const auto* thresh = _ramps.getReadPointer(kThreshRamp);
+    const auto* ceiling = _ramps.getReadPointer(kCeilingRamp);
+    const auto* mix = _ramps.getReadPointer(kMixRamp);
+    const auto* outputGain = _ramps.getReadPointer(kOutputRamp);
+    const auto* compensation = _ramps.getReadPointer(kCompensationRamp);
+    const auto* postGain = _ramps.getReadPointer(kPostGainRamp);
+    
+    // While the ceiling or threshold ramps, the curve changes every sample. The ramps are monotonic, so equal ends mean they hold still.
+    const auto* shapeRamp = type == ClipType::kSaturation ? thresh : ceiling;
+    
+    if (type == ClipType::kSoft || shapeRamp[0] == shapeRamp[numSamples - 1])
+    {
+        processAntiAliasedBlock<type, order>(input, output, numSamples, channel);
+        return;
+    }
+    
+    auto* states = _antiAliasingStates.data() + channel * maxAntiAliasingStages;
+    auto first = states[0];
+    auto second = states[1];
+    
+    // The knee's constants only change with the threshold, which is steady outside of its ramps
+    KneeShape knee(juce::jmax(1.0e-3, static_cast<double>(thresh[0])));
+    
+    // Same gain structure as processKernel(), with each curve swapped for its anti-aliased form
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = input[i];
+        const auto dry = 1 - mix[i];
+        SampleType wet;
+        
+        if constexpr (type == ClipType::kHard)
+        {
+            const HardShape shape {static_cast<double>(ceiling[i])};
+            wet = static_cast<SampleType>(antiAlias<order>(shape, x * drive[i], first)) * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kSoft)
+        {
+            wet = static_cast<SampleType>(antiAlias<order>(SoftShape(), x * drive[i], first)) * 2 * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kTube)
+        {
+            const TubeShape shape {{static_cast<double>(ceiling[i])}, {}};
+            const auto driven = x * drive[i];
+            const auto shaped = static_cast<SampleType>(antiAlias<order>(shape, driven * drive[i], first)) * compensation[i];
+            
+            wet = (shaped * mix[i] + driven * dry) * postGain[i];
+        }
+        
+        else if constexpr (type == ClipType::kSaturation)
+        {
+            const auto bias = static_cast<SampleType>(0.15);
+            const auto threshold = juce::jmax(1.0e-3, static_cast<double>(thresh[i]));
+            
+            if (threshold != knee.thresh)
+            {
+                knee = KneeShape(threshold);
+            }
+            
+            const auto kneed = static_cast<SampleType>(antiAlias<order>(knee, x * (drive[i] + bias), first));
+            const auto shaped = kneed * static_cast<SampleType>(1.5) * compensation[i] - bias;
+            
+            wet = shaped * dry + static_cast<SampleType>(antiAlias<order>(SoftShape(), shaped, second)) * mix[i];
+        }
+        
+        output[i] = (x * dry + wet * mix[i]) * outputGain[i];
+    }
+    
+    states[0] = first;
+    states[1] = second;
+}
+
+template <typename SampleType>
+template <typename viator_dsp::Distortion<SampleType>::ClipType type, int order>
+void viator_dsp::Distortion<SampleType>::processAntiAliasedBlock(const SampleType* input, SampleType* output, int numSamples, int channel) noexcept
+{
+    const auto* drive = _ramps.getReadPointer(kDriveRamp);
+    const auto* thresh = _ramps.getReadPointer(kThreshRamp);
+    const auto* ceiling = _ramps.getReadPointer(kCeilingRamp);
+    const auto* mix = _ramps.getReadPointer(kMixRamp);
+    const auto* outputGain = _ramps.getReadPointer(kOutputRamp);
+    const auto* compensation = _ramps.getReadPointer(kCompensationRamp);
+    const auto* postGain = _ramps.getReadPointer(kPostGainRamp);
+    
+    auto* states = _antiAliasingStates.data() + channel * maxAntiAliasingStages;
+    auto* curve = _antiAliasingScratch.getWritePointer(kCurveInput) + 2;
+    const auto* shaped = _antiAliasingScratch.getReadPointer(kCurveOutput);
+    const auto bias = static_cast<SampleType>(0.15);
+    
+    // The curve's input, rounded the same way as processAntiAliasedKernel()'s
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if constexpr (type == ClipType::kTube)
+        {
+            curve[i] = input[i] * drive[i] * drive[i];
+        }
+        
+        else if constexpr (type == ClipType::kSaturation)
+        {
+            curve[i] = input[i] * (drive[i] + bias);
+        }
+        
+        else
+        {
+            curve[i] = input[i] * drive[i];
+        }
+    }
+    
+    if constexpr (type == ClipType::kHard)
+    {
+        antiAliasBlock<order>(HardShape {static_cast<double>(ceiling[0])}, numSamples, states[0]);
+    }
+    
+    else if constexpr (type == ClipType::kSoft)
+    {
+        antiAliasBlock<order>(SoftShape(), numSamples, states[0]);
+    }
+    
+    else if constexpr (type == ClipType::kTube)
+    {
+        antiAliasBlock<order>(TubeShape {{static_cast<double>(ceiling[0])}, {}}, numSamples, states[0]);
+    }
+    
+    // The knee's output, with its gain, is both the soft clip's input and the dry half of its mix
+    else if constexpr (type == ClipType::kSaturation)
+    {
+        antiAliasBlock<order>(KneeShape(juce::jmax(1.0e-3, static_cast<double>(thresh[0]))), numSamples, states[0]);
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            curve[i] = static_cast<SampleType>(shaped[i]) * static_cast<SampleType>(1.5) * compensation[i] - bias;
+        }
+        
+        antiAliasBlock<order>(SoftShape(), numSamples, states[1]);
+    }
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = input[i];
+        const auto dry = 1 - mix[i];
+        const auto y = static_cast<SampleType>(shaped[i]);
+        SampleType wet;
+        
+        if constexpr (type == ClipType::kHard)
+        {
+            wet = y * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kSoft)
+        {
+            wet = y * 2 * compensation[i];
+        }
+        
+        else if constexpr (type == ClipType::kTube)
+        {
+            wet = (y * compensation[i] * mix[i] + x * drive[i] * dry) * postGain[i];
+        }
+        
+        else if constexpr (type == ClipType::kSaturation)
+        {
+            wet = static_cast<SampleType>(curve[i]) * dry + y * mix[i];
+        }
+        
+        output[i] = (x * dry + wet * mix[i]) * outputGain[i];
+    }
+}
+
 template class viator_dsp::Distortion<float>;
 template class viator_dsp::Distortion<double>;
@@ -0,0 +1,273 @@
+#include "DynamicEQ.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+
+    sampleRate = spec.sampleRate;
+    scratch = juce::dsp::AudioBlock<SampleType> (scratchData, spec.numChannels, spec.maximumBlockSize);
+
+    for (auto& band : bands)
+    {
+        band.filter.prepare (spec);
+        updateFilter (band);
+        updateBallistics (band);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::reset()
+{
+    for (auto& band : bands)
+    {
+        resetBand (band);
+    }
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::resetBand (Band& band)
+{
+    band.filter.reset();
+    band.envelope = 0.0;
+    band.gain = 0.0;
+    band.intervalPeak = 0.0;
+    band.intervalPosition = 0;
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setBandEnabled (int band, bool shouldBeEnabled)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    auto& target = bands[(size_t) band];
+
+    if (shouldBeEnabled && ! target.enabled)
+        resetBand (target);
+
+    target.enabled = shouldBeEnabled;
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setBandType (int band, BandType newType)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].type = newType;
+    updateFilter (bands[(size_t) band]);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setFrequency (int band, SampleType newFrequency)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].frequency = newFrequency;
+    updateFilter (bands[(size_t) band]);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setQ (int band, SampleType newQ)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].q = newQ;
+    updateFilter (bands[(size_t) band]);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setThreshold (int band, SampleType newThreshold)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].threshold = newThreshold;
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setRatio (int band, SampleType newRatio)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+    jassert (newRatio >= static_cast<SampleType> (1.0));
+
+    bands[(size_t) band].ratio = newRatio;
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setRange (int band, SampleType newRange)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    auto& target = bands[(size_t) band];
+
+    // Picks up from the static response, as setBandEnabled() does
+    if (target.range == 0 && newRange != 0)
+        resetBand (target);
+
+    target.range = newRange;
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setAttack (int band, SampleType newAttack)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].attack = newAttack;
+    updateBallistics (bands[(size_t) band]);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setRelease (int band, SampleType newRelease)
+{
+    jassert (juce::isPositiveAndBelow (band, maxBands));
+
+    bands[(size_t) band].release = newRelease;
+    updateBallistics (bands[(size_t) band]);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::setControlInterval (int newControlInterval)
+{
+    controlInterval = juce::jlimit (minControlInterval, maxControlInterval, newControlInterval);
+
+    for (auto& band : bands)
+    {
+        // An interval in progress may already be longer than the new one
+        band.intervalPeak = 0.0;
+        band.intervalPosition = 0;
+        updateBallistics (band);
+    }
+}
+
+template <typename SampleType>
+SampleType DynamicEQ<SampleType>::getBandGain (int band) const noexcept
+{
+    return static_cast<SampleType> (20.0 * std::log10 (1.0 + bands[(size_t) band].gain));
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::updateFilter (Band& band)
+{
+    using Filter = SVFilter<SampleType>;
+
+    const auto filterType = band.type == BandType::kLowShelf ? Filter::FilterType::kLowPass
+                          : band.type == BandType::kHighShelf ? Filter::FilterType::kHighPass
+                                                              : Filter::FilterType::kBandPass;
+
+    // SVFilter only picks up a new Q when the cutoff is prewarped, so the cutoff goes last
+    band.filter.setParameter (Filter::ParameterId::kType, filterType);
+    band.filter.setParameter (Filter::ParameterId::kQType, Filter::QType::kParametric);
+    band.filter.setParameter (Filter::ParameterId::kQ, band.q);
+    band.filter.setParameter (Filter::ParameterId::kCutoff, band.frequency);
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::updateBallistics (Band& band)
+{
+    // One envelope step per control interval
+    const auto stepsPerMs = 0.001 * sampleRate / controlInterval;
+    band.attackCoefficient = std::exp (-1.0 / (juce::jmax (static_cast<double> (band.attack), 0.01) * stepsPerMs));
+    band.releaseCoefficient = std::exp (-1.0 / (juce::jmax (static_cast<double> (band.release), 0.01) * stepsPerMs));
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    if (context.isBypassed)
+        return;
+
+    const auto& block = context.getOutputBlock();
+
+    jassert (block.getNumChannels() <= scratch.getNumChannels());
+    jassert (block.getNumSamples() <= scratch.getNumSamples());
+
+    for (auto& band : bands)
+    {
+        if (band.enabled && band.range != 0)
+            processBand (band, block);
+    }
+}
+
+template <typename SampleType>
+void DynamicEQ<SampleType>::processBand (Band& band, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+
+    // The low, band or high pass the shelf or bell adds back, which is also the detector
+    auto component = scratch.getSubsetChannelBlock (0, numChannels).getSubBlock (0, numSamples);
+    component.copyFrom (block);
+    band.filter.process (juce::dsp::ProcessContextReplacing<SampleType> (component));
+
+    const auto direction = band.range < 0 ? -1.0 : 1.0;
+    const auto maximumChange = std::abs (static_cast<double> (band.range));
+    const auto slope = 1.0 - 1.0 / static_cast<double> (band.ratio);
+    const auto interval = static_cast<size_t> (controlInterval);
+
+    // Intervals run on across blocks, so the envelope takes the same steps whatever the host block size
+    for (size_t start = 0; start < numSamples;)
+    {
+        const auto length = juce::jmin (interval - band.intervalPosition, numSamples - start);
+
+        // Linked peak of the band over the interval so far
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax (component.getChannelPointer (channel) + start, (int) length);
+            band.intervalPeak = juce::jmax (band.intervalPeak, static_cast<double> (-range.getStart()), static_cast<double> (range.getEnd()));
+        }
+
+        band.intervalPosition += length;
+
+        const auto peak = band.intervalPeak;
+        auto coefficient = peak > band.envelope ? band.attackCoefficient : band.releaseCoefficient;
+        auto envelope = band.envelope;
+
+        if (band.intervalPosition == interval)
+        {
+            // A whole interval: one envelope step
+            envelope = peak + coefficient * (envelope - peak);
+            band.envelope = envelope;
+            band.intervalPeak = 0.0;
+            band.intervalPosition = 0;
+        }
+        else
+        {
+            // The block ends mid-interval: the gain follows its share of a step, and the
+            // next block finishes the interval from the same envelope
+            coefficient = std::pow (coefficient, static_cast<double> (band.intervalPosition) / static_cast<double> (interval));
+            envelope = peak + coefficient * (envelope - peak);
+        }
+
+        const auto over = 20.0 * std::log10 (juce::jmax (envelope, 1.0e-6)) - static_cast<double> (band.threshold);
+        const auto change = over > 0.0 ? juce::jmin (over * slope, maximumChange) : 0.0;
+        const auto target = std::pow (10.0, direction * change * 0.05) - 1.0;
+
+        // gain - 1 ramps from the last interval's value to this one's
+        const auto step = static_cast<SampleType> ((target - band.gain) / static_cast<double> (length));
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* output = block.getChannelPointer (channel) + start;
+            const auto* filtered = component.getChannelPointer (channel) + start;
+            auto gain = static_cast<SampleType> (band.gain);
+
+            for (size_t i = 0; i < length; ++i)
+            {
+                gain += step;
+                output[i] += filtered[i] * gain;
+            }
+        }
+
+        band.gain = target;
+        start += length;
+    }
+}
+
+template class DynamicEQ<float>;
+template class DynamicEQ<double>;
+
+} // namespace viator_dsp
@@ -0,0 +1,123 @@
+#ifndef DynamicEQ_h
+#define DynamicEQ_h
+
+#include "../Common/Common.h"
+#include "SVFilter.h"
+
+namespace viator_dsp
+{
+
+/**
+    Dynamic EQ: up to maxBands SVFilter bells and shelves in series, each with
+    its gain driven by its own detector.
+
+    SVFilter's shelves and bell are the input plus one filter output scaled by
+    (gain - 1): the low pass for kLowShelf, the high pass for kHighShelf and the
+    scaled band pass for kBandShelf. So each band runs its SVFilter as that low,
+    band or high pass on a copy of the block. That output is the band's
+    detector, so a bell listens through its own band pass. It is also what the
+    band adds back, scaled by the gain.
+
+    The detector, envelope and gain curve run once every control interval (16
+    to 32 samples): the peak of the band over the interval, across every
+    channel, goes through an attack/release envelope. Above the threshold the
+    gain moves by (1 - 1 / ratio) dB per dB, up to the band's range. A negative
+    range cuts and a positive one boosts. The gain is interpolated linearly
+    across each interval, so there are no coefficient updates in the audio loop.
+    Intervals carry over from one block to the next, so the attack and release
+    don't depend on the host's block size.
+
+    Bands with a range of 0 dB or that are disabled are skipped for the whole block.
+*/
+template <typename SampleType>
+class DynamicEQ
+{
+public:
+
+    enum class BandType
+    {
+        kLowShelf,
+        kBell,
+        kHighShelf
+    };
+
+    static constexpr int maxBands = 4;
+    static constexpr int minControlInterval = 16;
+    static constexpr int maxControlInterval = 32;
+
+    /** Initialises the processor. Allocates the scratch buffer, so call it off the audio thread. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /** Resets every band's filter, envelope and gain. */
+    void reset();
+
+    /** A band that is switched back on starts from its static response. */
+    void setBandEnabled (int band, bool shouldBeEnabled);
+
+    void setBandType (int band, BandType newType);
+
+    /** Sets the bell's centre or the shelf's corner frequency, in Hz. */
+    void setFrequency (int band, SampleType newFrequency);
+
+    /** Sets SVFilter's parametric Q, between 0 and 1. */
+    void setQ (int band, SampleType newQ);
+
+    /** Sets the detector level in dB above which the band starts to move. */
+    void setThreshold (int band, SampleType newThreshold);
+
+    /** Sets the dB of gain change per dB over the threshold, as 1 - 1 / ratio. Must be at least 1. */
+    void setRatio (int band, SampleType newRatio);
+
+    /** Sets the most gain the band applies, in dB. Negative cuts, positive boosts, 0 turns the band off. */
+    void setRange (int band, SampleType newRange);
+
+    /** Sets the detector's attack and release in milliseconds. */
+    void setAttack (int band, SampleType newAttack);
+    void setRelease (int band, SampleType newRelease);
+
+    /** Sets how many samples pass between gain computations, between minControlInterval and maxControlInterval. */
+    void setControlInterval (int newControlInterval);
+
+    /** The gain band applied at the end of the last block, in dB */
+    SampleType getBandGain (int band) const noexcept;
+
+    /** Runs every active band over the block, in band order. */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+
+    struct Band
+    {
+        SVFilter<SampleType> filter;
+        BandType type = BandType::kBell;
+        SampleType frequency = 1000, q = static_cast<SampleType> (0.3);
+        SampleType threshold = -24, ratio = 4, range = 0;
+        SampleType attack = 5, release = 100;
+        bool enabled = true;
+
+        /** Control rate state: the envelope, the ballistics and the current gain - 1 */
+        double envelope = 0.0, attackCoefficient = 0.0, releaseCoefficient = 0.0;
+        double gain = 0.0;
+
+        /** The interval in progress, carried across blocks: its peak so far and how many samples it has seen */
+        double intervalPeak = 0.0;
+        size_t intervalPosition = 0;
+    };
+
+    void updateFilter (Band& band);
+    void updateBallistics (Band& band);
+    void resetBand (Band& band);
+    void processBand (Band& band, const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    std::array<Band, maxBands> bands;
+
+    juce::HeapBlock<char> scratchData;
+    juce::dsp::AudioBlock<SampleType> scratch;
+
+    double sampleRate = 44100.0;
+    int controlInterval = minControlInterval;
+};
+
+} // namespace viator_dsp
+
+#endif /* DynamicEQ_h */
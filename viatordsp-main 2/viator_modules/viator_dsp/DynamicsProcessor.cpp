@@ -0,0 +1,285 @@
+#include "DynamicsProcessor.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+DynamicsProcessor<SampleType>::DynamicsProcessor()
+{
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+    maximumBlockSize = juce::jmax ((size_t) 1, (size_t) spec.maximumBlockSize);
+
+    // Channel 0 holds the envelope, channel 1 the level/gain. Both are SIMD aligned.
+    scratch = juce::dsp::AudioBlock<SampleType> (scratchData, 2, maximumBlockSize);
+    envelopeState.resize (spec.numChannels);
+
+    lookahead.prepare (spec, (int) std::ceil (maximumLookaheadMs * 0.001 * sampleRate));
+    setLookahead (lookaheadTime);
+
+    update();
+    reset();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::reset()
+{
+    std::fill (envelopeState.begin(), envelopeState.end(), static_cast<SampleType> (0.0));
+    lookahead.reset();
+}
+
+template <typename SampleType>
+SampleType DynamicsProcessor<SampleType>::processSample (int channel, SampleType inputValue)
+{
+    // Lookahead peak hold and audio delay
+    auto rectified = std::abs (inputValue);
+    lookahead.processPeakHold (channel, &rectified, 1);
+    lookahead.processDelay (channel, &inputValue, 1);
+
+    // Ballistics filter with peak rectifier
+    auto& env = envelopeState[(size_t) channel];
+    const auto cte = rectified > env ? cteAttack : cteRelease;
+    env = rectified + cte * (env - rectified);
+
+    // Gain curve in log2 units
+    auto gain = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (env)));
+    applyGainCurve (&gain, 1);
+
+    // VCA
+    return static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain))) * inputValue;
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::computeGain (int detectorChannel, int numSamples) noexcept
+{
+    auto* envelope = scratch.getChannelPointer (0);
+    auto* gain     = scratch.getChannelPointer (1);
+
+    // Detector: hold the upcoming peak, then the attack/release recursion
+    lookahead.processPeakHold (detectorChannel, envelope, numSamples);
+
+    auto env = envelopeState[(size_t) detectorChannel];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto cte = envelope[i] > env ? cteAttack : cteRelease;
+        env = envelope[i] + cte * (env - envelope[i]);
+        envelope[i] = env;
+    }
+
+    envelopeState[(size_t) detectorChannel] = env;
+
+    // Level in log2 units
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (envelope[i])));
+
+    // Both sides of the curve in one pass
+    applyGainCurve (gain, numSamples);
+
+    // Linear gain
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain[i])));
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::applyGain (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+{
+    // Audio path is delayed by the same lookahead so it meets the held peak
+    if (output != input)
+        juce::FloatVectorOperations::copy (output, input, numSamples);
+
+    lookahead.processDelay (channel, output, numSamples);
+
+    // VCA
+    juce::FloatVectorOperations::multiply (output, scratch.getChannelPointer (1), numSamples);
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::applyGainCurve (SampleType* levels, int numSamples) const noexcept
+{
+    using SIMD = juce::dsp::SIMDRegister<SampleType>;
+
+    const auto simdSize = (int) SIMD::size();
+
+    const auto lowerThresholdRegister = SIMD::expand (lowerThresholdLog2);
+    const auto lowerHalfKneeRegister  = SIMD::expand (lowerHalfKnee);
+    const auto lowerKneeRegister      = SIMD::expand (static_cast<SampleType> (2.0) * lowerHalfKnee);
+    const auto lowerScaleRegister     = SIMD::expand (lowerKneeScale);
+    const auto expansionRegister      = SIMD::expand (expansionSlope);
+    const auto rangeRegister          = SIMD::expand (rangeLog2);
+
+    const auto upperThresholdRegister = SIMD::expand (upperThresholdLog2);
+    const auto upperHalfKneeRegister  = SIMD::expand (upperHalfKnee);
+    const auto upperKneeRegister      = SIMD::expand (static_cast<SampleType> (2.0) * upperHalfKnee);
+    const auto upperScaleRegister     = SIMD::expand (upperKneeScale);
+    const auto compressionRegister    = SIMD::expand (compressionSlope);
+
+    const auto zeroRegister = SIMD::expand (static_cast<SampleType> (0.0));
+
+    // How far past a threshold the level is, with the knee's quadratic blend:
+    // 0 below the knee, (over + W/2)^2 / 2W inside it and over above it
+    const auto kneeRegister = [&zeroRegister] (SIMD over, SIMD halfKnee, SIMD knee, SIMD scale)
+    {
+        const auto inside = SIMD::min (knee, SIMD::max (zeroRegister, over + halfKnee));
+        return inside * inside * scale + SIMD::max (zeroRegister, over - halfKnee);
+    };
+
+    int i = 0;
+
+    // levels is the aligned scratch buffer, so every full register load is aligned
+    for (; i + simdSize <= numSamples; i += simdSize)
+    {
+        const auto level = SIMD::fromRawArray (levels + i);
+
+        const auto below = kneeRegister (lowerThresholdRegister - level, lowerHalfKneeRegister, lowerKneeRegister, lowerScaleRegister);
+        const auto above = kneeRegister (level - upperThresholdRegister, upperHalfKneeRegister, upperKneeRegister, upperScaleRegister);
+
+        (SIMD::max (rangeRegister, below * expansionRegister) + above * compressionRegister).copyToRawArray (levels + i);
+    }
+
+    const auto knee = [] (SampleType over, SampleType halfKnee, SampleType scale)
+    {
+        const auto inside = juce::jlimit (static_cast<SampleType> (0.0), static_cast<SampleType> (2.0) * halfKnee, over + halfKnee);
+        return inside * inside * scale + juce::jmax (static_cast<SampleType> (0.0), over - halfKnee);
+    };
+
+    for (; i < numSamples; ++i)
+    {
+        const auto below = knee (lowerThresholdLog2 - levels[i], lowerHalfKnee, lowerKneeScale);
+        const auto above = knee (levels[i] - upperThresholdLog2, upperHalfKnee, upperKneeScale);
+
+        levels[i] = juce::jmax (rangeLog2, below * expansionSlope) + above * compressionSlope;
+    }
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::update()
+{
+    constexpr auto log2PerDecibel = 0.16609640474436813; // log2 (10) / 20
+
+    // A hard knee is a very narrow soft one, which keeps the curve free of branches
+    constexpr auto minimumKneeLog2 = 1.0e-4;
+
+    const auto lowerKnee = juce::jmax (lowerKneedB * log2PerDecibel, minimumKneeLog2);
+    const auto upperKnee = juce::jmax (upperKneedB * log2PerDecibel, minimumKneeLog2);
+
+    lowerThresholdLog2 = static_cast<SampleType> (lowerThresholddB * log2PerDecibel);
+    lowerHalfKnee      = static_cast<SampleType> (0.5 * lowerKnee);
+    lowerKneeScale     = static_cast<SampleType> (0.5 / lowerKnee);
+    expansionSlope     = static_cast<SampleType> (1.0) - expansionRatio;
+    rangeLog2          = static_cast<SampleType> (rangedB * log2PerDecibel);
+
+    upperThresholdLog2 = static_cast<SampleType> (upperThresholddB * log2PerDecibel);
+    upperHalfKnee      = static_cast<SampleType> (0.5 * upperKnee);
+    upperKneeScale     = static_cast<SampleType> (0.5 / upperKnee);
+    compressionSlope   = static_cast<SampleType> (1.0) / compressionRatio - static_cast<SampleType> (1.0);
+
+    // Same time constants as juce::dsp::BallisticsFilter
+    cteAttack  = attackTime  < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / attackTime));
+    cteRelease = releaseTime < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / releaseTime));
+}
+
+#pragma mark Setters
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setLowerThreshold (SampleType newThreshold)
+{
+    lowerThresholddB = newThreshold;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setExpansionRatio (SampleType newRatio)
+{
+    jassert (newRatio >= static_cast<SampleType> (1.0));
+
+    expansionRatio = newRatio;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setLowerKnee (SampleType newKnee)
+{
+    jassert (newKnee >= static_cast<SampleType> (0.0));
+
+    lowerKneedB = newKnee;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setRange (SampleType newRange)
+{
+    jassert (newRange <= static_cast<SampleType> (0.0));
+
+    rangedB = newRange;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setUpperThreshold (SampleType newThreshold)
+{
+    upperThresholddB = newThreshold;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setCompressionRatio (SampleType newRatio)
+{
+    jassert (newRatio >= static_cast<SampleType> (1.0));
+
+    compressionRatio = newRatio;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setUpperKnee (SampleType newKnee)
+{
+    jassert (newKnee >= static_cast<SampleType> (0.0));
+
+    upperKneedB = newKnee;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setAttack (SampleType newAttack)
+{
+    attackTime = newAttack;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setRelease (SampleType newRelease)
+{
+    releaseTime = newRelease;
+    update();
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setLookahead (SampleType newLookahead)
+{
+    jassert (newLookahead >= static_cast<SampleType> (0.0) && newLookahead <= static_cast<SampleType> (maximumLookaheadMs));
+
+    lookaheadTime = newLookahead;
+    lookahead.setDelay (juce::roundToInt (lookaheadTime * 0.001 * sampleRate));
+}
+
+template <typename SampleType>
+void DynamicsProcessor<SampleType>::setLinkMode (LinkMode newLinkMode)
+{
+    linkMode = newLinkMode;
+}
+
+} // namespace viator_dsp
+
+template class viator_dsp::DynamicsProcessor<float>;
+template class viator_dsp::DynamicsProcessor<double>;
@@ -0,0 +1,204 @@
+#ifndef DynamicsProcessor_h
+#define DynamicsProcessor_h
+
+#include "../Common/Common.h"
+#include "LookaheadDelay.h"
+
+namespace viator_dsp
+{
+
+/**
+    Downward expander and compressor sharing one detector and one gain curve.
+
+    Running Expander and Compressor in series means two envelope detectors, two
+    log conversions, two exp conversions and two VCA passes over the same
+    signal. Here the passes run once, as in Compressor:
+
+        rectify -> lookahead peak hold -> envelope -> log2 level -> gain curve -> linear gain -> apply
+
+    The gain curve is piecewise in log2 units. Below the lower threshold it
+    expands by (expansion ratio - 1) per unit, down to the range. Between the
+    thresholds the gain is unity. Above the upper threshold it compresses by
+    (1 / compression ratio - 1) per unit. Each threshold can have a soft knee,
+    across which the slope blends in quadratically. Both sides and both knees
+    are evaluated with min/max on juce::dsp::SIMDRegister, without branches, in
+    the one curve pass. Set the expansion ratio or compression ratio to 1 to
+    drop either side.
+
+    The envelope has the same attack and release as juce::dsp::BallisticsFilter,
+    and so does Compressor. Rising levels use the attack for both sides: the
+    expander opens and the compressor clamps down at the same rate.
+
+    With LinkMode::kMaxLinked the loudest channel drives one detector whose
+    gain is applied to every channel.
+*/
+template <typename SampleType>
+class DynamicsProcessor
+{
+public:
+
+    /** How the detector treats multiple channels. */
+    enum class LinkMode
+    {
+        kUnlinked,
+        kMaxLinked
+    };
+
+    /** Constructor. */
+    DynamicsProcessor();
+
+    /** Sets the threshold in dB below which the signal is expanded.*/
+    void setLowerThreshold (SampleType newThreshold);
+
+    /** Sets the expansion ratio (must be higher or equal to 1, 1 turns expansion off).*/
+    void setExpansionRatio (SampleType newRatio);
+
+    /** Sets the width in dB of the knee around the lower threshold, 0 for a hard knee.*/
+    void setLowerKnee (SampleType newKnee);
+
+    /** Sets the deepest expansion in dB, 0 or below.*/
+    void setRange (SampleType newRange);
+
+    /** Sets the threshold in dB above which the signal is compressed.*/
+    void setUpperThreshold (SampleType newThreshold);
+
+    /** Sets the compression ratio (must be higher or equal to 1, 1 turns compression off).*/
+    void setCompressionRatio (SampleType newRatio);
+
+    /** Sets the width in dB of the knee around the upper threshold, 0 for a hard knee.*/
+    void setUpperKnee (SampleType newKnee);
+
+    /** Sets the attack time in milliseconds of the detector.*/
+    void setAttack (SampleType newAttack);
+
+    /** Sets the release time in milliseconds of the detector.*/
+    void setRelease (SampleType newRelease);
+
+    /** Sets the lookahead time in milliseconds, between 0 and maximumLookaheadMs.*/
+    void setLookahead (SampleType newLookahead);
+
+    /** Sets whether the channels share one detector. processSample() is always unlinked.*/
+    void setLinkMode (LinkMode newLinkMode);
+
+    /** Returns the latency added by the lookahead, in samples. */
+    int getLatencySamples() const noexcept { return lookahead.getDelay(); }
+
+    static constexpr double maximumLookaheadMs = 20.0;
+
+    /** Initialises the processor. Allocates the scratch buffers, so call it off the audio thread. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /** Resets the internal state variables of the processor. */
+    void reset();
+
+    /** Processes the input and output samples supplied in the processing context. */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples  = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumChannels() == numChannels);
+        jassert (inputBlock.getNumSamples()  == numSamples);
+        jassert (numChannels <= envelopeState.size());
+
+        if (context.isBypassed)
+        {
+            // Still run the delay so the reported latency holds while bypassed
+            outputBlock.copyFrom (inputBlock);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                lookahead.processDelay ((int) channel, outputBlock.getChannelPointer (channel), (int) numSamples);
+
+            return;
+        }
+
+        // Hosts may send more than maximumBlockSize, so walk the block in scratch-sized chunks
+        for (size_t start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            const auto length = juce::jmin (maximumBlockSize, numSamples - start);
+
+            if (linkMode == LinkMode::kMaxLinked && numChannels > 1)
+            {
+                auto* envelope = scratch.getChannelPointer (0);
+                auto* rectified = scratch.getChannelPointer (1);
+
+                // Loudest channel at every sample; the gain channel is free until computeGain()
+                juce::FloatVectorOperations::abs (envelope, inputBlock.getChannelPointer (0) + start, (int) length);
+
+                for (size_t channel = 1; channel < numChannels; ++channel)
+                {
+                    juce::FloatVectorOperations::abs (rectified, inputBlock.getChannelPointer (channel) + start, (int) length);
+                    juce::FloatVectorOperations::max (envelope, envelope, rectified, (int) length);
+                }
+
+                // The shared detector keeps its state in channel 0
+                computeGain (0, (int) length);
+
+                for (size_t channel = 0; channel < numChannels; ++channel)
+                {
+                    applyGain ((int) channel,
+                               inputBlock.getChannelPointer (channel) + start,
+                               outputBlock.getChannelPointer (channel) + start,
+                               (int) length);
+                }
+
+                continue;
+            }
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* input = inputBlock.getChannelPointer (channel) + start;
+
+                juce::FloatVectorOperations::abs (scratch.getChannelPointer (0), input, (int) length);
+                computeGain ((int) channel, (int) length);
+                applyGain ((int) channel, input, outputBlock.getChannelPointer (channel) + start, (int) length);
+            }
+        }
+    }
+
+    /** Performs the processing operation on a single sample at a time. */
+    SampleType processSample (int channel, SampleType inputValue);
+
+private:
+    void update();
+
+    /** Turns the rectified detector signal in scratch channel 0 into a linear gain in scratch channel 1. */
+    void computeGain (int detectorChannel, int numSamples) noexcept;
+
+    /** Delays the audio path and multiplies it by the gain in scratch channel 1. */
+    void applyGain (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept;
+
+    /** Turns log2 levels into log2 gains in place. */
+    void applyGainCurve (SampleType* levels, int numSamples) const noexcept;
+
+private:
+    juce::HeapBlock<char> scratchData;
+    juce::dsp::AudioBlock<SampleType> scratch;
+    size_t maximumBlockSize = 0;
+
+    std::vector<SampleType> envelopeState;
+
+    LinkMode linkMode = LinkMode::kUnlinked;
+
+    LookaheadDelay<SampleType> lookahead;
+
+private:
+    /** The curve in log2 units. Each knee is stored as its half width and 1 / (2 * width). */
+    SampleType lowerThresholdLog2, lowerHalfKnee, lowerKneeScale, expansionSlope, rangeLog2;
+    SampleType upperThresholdLog2, upperHalfKnee, upperKneeScale, compressionSlope;
+    SampleType cteAttack, cteRelease;
+
+    double sampleRate = 44100.0;
+    double expFactor = 0.0;
+
+    SampleType lowerThresholddB = -60.0, expansionRatio = 1.0, lowerKneedB = 0.0, rangedB = -120.0;
+    SampleType upperThresholddB = 0.0, compressionRatio = 1.0, upperKneedB = 0.0;
+    SampleType attackTime = 1.0, releaseTime = 100.0, lookaheadTime = 0.0;
+};
+
+} // namespace viator_dsp
+
+#endif /* DynamicsProcessor_h */
@@ -16,8 +16,19 @@ void Expander<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
     jassert (spec.numChannels > 0);
 
     sampleRate = spec.sampleRate;
+    expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+    maximumBlockSize = juce::jmax ((size_t) 1, (size_t) spec.maximumBlockSize);
 
-    envelopeFilter.prepare (spec);
+    attackPowers.resize (maximumBlockSize);
+    releasePowers.resize (maximumBlockSize);
+
+    // Each group of registerSize channels runs through the scratch rows in turn
+    const auto numGroups = (spec.numChannels + registerSize - 1) / registerSize;
+    scratch = juce::dsp::AudioBlock<Register> (scratchData, kNumScratchRows, maximumBlockSize);
+    gateState = juce::dsp::AudioBlock<Register> (gateStateData, numGroups, kNumStates);
+
+    lookahead.prepare (spec, (int) std::ceil (maximumLookaheadMs * 0.001 * sampleRate));
+    setLookahead (lookaheadTime);
 
     update();
     reset();
@@ -26,32 +37,543 @@ void Expander<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 template <typename SampleType>
 void Expander<SampleType>::reset()
 {
-    envelopeFilter.reset();
+    // Start closed, at the curve's gain for silence, so the first transient opens the gate.
+    // With a ratio of 1 that is unity, and a transparent expander doesn't fade in.
+    const auto silenceLog2 = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (0.0f));
+
+    SampleType silenceGain;
+    applyGainCurve (&silenceLog2, &silenceGain, 1);
+
+    for (size_t group = 0; group < gateState.getNumChannels(); ++group)
+    {
+        gateState.getChannelPointer (group)[kGain] = Register::expand (silenceGain);
+        gateState.getChannelPointer (group)[kHold] = Register::expand (static_cast<SampleType> (0.0));
+    }
+
+    lookahead.reset();
 }
 
 template <typename SampleType>
 SampleType Expander<SampleType>::processSample (int channel, SampleType inputValue)
 {
-    // Ballistics filter with peak rectifier
-    auto env = envelopeFilter.processSample (channel, inputValue);
+    // The detector hears the sample before the lookahead delays it
+    const auto level = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (std::abs (inputValue))));
+    lookahead.processDelay (channel, &inputValue, 1);
+
+    SampleType closedGain;
+    applyGainCurve (&level, &closedGain, 1);
+
+    // The channel's lane of its group's state
+    auto* state = reinterpret_cast<SampleType*> (gateState.getChannelPointer ((size_t) channel / registerSize));
+    const auto lane = (size_t) channel % registerSize;
+
+    const auto gain = smoothGain (state[kGain * registerSize + lane], stepGate (state[kHold * registerSize + lane], level, closedGain));
 
     // VCA
-    auto gain = (env < threshold) ? std::pow (env * thresholdInverse, ratioInverse - static_cast<SampleType> (1.0))
-                                  : std::pow (env * thresholdInverse, ratioInverse);
+    return static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain))) * inputValue;
+}
+
+template <typename SampleType>
+void Expander<SampleType>::processGroup (size_t group,
+                                         const juce::dsp::AudioBlock<const SampleType>& input,
+                                         const juce::dsp::AudioBlock<SampleType>& output) noexcept
+{
+    const auto numSamples   = (int) output.getNumSamples();
+    const auto firstChannel = group * registerSize;
+    const auto endChannel   = juce::jmin (output.getNumChannels(), firstChannel + registerSize);
+
+    // A lone channel has no lanes to share the recursions with, and they have less latency on scalars
+    if (endChannel - firstChannel == 1)
+    {
+        processChannel (firstChannel, input.getChannelPointer (firstChannel), output.getChannelPointer (firstChannel), numSamples);
+        return;
+    }
+
+    // The settled path runs a channel at a time, so it needs every channel of the group to take it
+    std::array<SettledRuns, registerSize> runs;
+    auto allSettled = true;
+
+    for (auto channel = firstChannel; channel < endChannel && allSettled; ++channel)
+        allSettled = findSettledRuns (channel, input.getChannelPointer (channel), numSamples, runs[channel - firstChannel]);
+
+    if (allSettled)
+    {
+        for (auto channel = firstChannel; channel < endChannel; ++channel)
+        {
+            if (output.getChannelPointer (channel) != input.getChannelPointer (channel))
+                juce::FloatVectorOperations::copy (output.getChannelPointer (channel), input.getChannelPointer (channel), numSamples);
+
+            lookahead.processDelay ((int) channel, output.getChannelPointer (channel), numSamples);
+            applySettledRuns (channel, runs[channel - firstChannel], output.getChannelPointer (channel));
+        }
+
+        return;
+    }
+
+    auto* levelRegisters = scratch.getChannelPointer (kLevels);
+    auto* gainRegisters  = scratch.getChannelPointer (kGains);
+    auto* levels = reinterpret_cast<SampleType*> (levelRegisters);
+    auto* gains  = reinterpret_cast<SampleType*> (gainRegisters);
+
+    // One channel's samples, contiguous, so the log2 and exp2 passes only run over real channels
+    auto* channelValues = reinterpret_cast<SampleType*> (scratch.getChannelPointer (kChannel));
+
+    // Detector: each channel's level in log2 units, ahead of the lookahead delay, into its lane.
+    // Spare lanes hear silence, which settles them closed.
+    const auto silenceLog2 = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (0.0f));
+    auto highestLevel = silenceLog2;
+
+    if (endChannel - firstChannel < registerSize)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            levelRegisters[i] = Register::expand (silenceLog2);
+    }
+
+    for (auto channel = firstChannel; channel < endChannel; ++channel)
+    {
+        const auto* source = input.getChannelPointer (channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            channelValues[i] = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (std::abs (source[i]))));
+
+        highestLevel = juce::jmax (highestLevel, juce::FloatVectorOperations::findMaximum (channelValues, numSamples));
+
+        for (int i = 0; i < numSamples; ++i)
+            levels[(size_t) i * registerSize + channel - firstChannel] = channelValues[i];
+    }
+
+    // Gain curve in log2 units, over every lane at once
+    applyGainCurve (levels, gains, numSamples * (int) registerSize);
+
+    auto* state = gateState.getChannelPointer (group);
+    const auto zeroRegister = Register::expand (static_cast<SampleType> (0.0));
+
+    // The gate's target: unity while open. Without hysteresis or hold that is already the curve,
+    // and so it is for a closed group whose levels all stay below the threshold.
+    const auto staysClosed = state[kHold].allValuesEqualTo (static_cast<SampleType> (0.0)) && highestLevel < thresholdLog2;
+
+    if ((closeThresholdLog2 < thresholdLog2 || holdSamples > 0) && ! staysClosed)
+    {
+        const auto thresholdRegister      = Register::expand (thresholdLog2);
+        const auto closeThresholdRegister = Register::expand (closeThresholdLog2);
+        const auto oneRegister            = Register::expand (static_cast<SampleType> (1.0));
+        const auto reloadRegister         = Register::expand (static_cast<SampleType> (holdSamples + 1));
+
+        auto hold = state[kHold];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // Open at the threshold, or stay open above the hysteresis. Both reload the hold,
+            // which then counts down. Only the open test waits on the last sample.
+            const auto opens = reloadRegister & Register::greaterThanOrEqual (levelRegisters[i], thresholdRegister);
+            const auto keeps = reloadRegister & Register::greaterThanOrEqual (levelRegisters[i], closeThresholdRegister);
+
+            hold = Register::max (Register::max (hold - oneRegister, opens), keeps & Register::greaterThan (hold, zeroRegister));
+            gainRegisters[i] = gainRegisters[i] & Register::lessThanOrEqual (hold, zeroRegister);
+        }
+
+        state[kHold] = hold;
+    }
+
+    // Audio path is delayed by the same lookahead so it meets the held peak
+    for (auto channel = firstChannel; channel < endChannel; ++channel)
+    {
+        if (output.getChannelPointer (channel) != input.getChannelPointer (channel))
+            juce::FloatVectorOperations::copy (output.getChannelPointer (channel), input.getChannelPointer (channel), numSamples);
+
+        lookahead.processDelay ((int) channel, output.getChannelPointer (channel), numSamples);
+    }
+
+    // The same fast path as processChannel(), once every lane has settled
+    auto changed = Register::notEqual (gainRegisters[0], state[kGain]);
+
+    for (int i = 1; i < numSamples; ++i)
+        changed = changed | Register::notEqual (gainRegisters[i], state[kGain]);
+
+    if (changed.allValuesEqualTo (0))
+    {
+        for (auto channel = firstChannel; channel < endChannel; ++channel)
+        {
+            const auto gain = state[kGain].get (channel - firstChannel);
+
+            if (gain < static_cast<SampleType> (0.0))
+                juce::FloatVectorOperations::multiply (output.getChannelPointer (channel), static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain))), numSamples);
+        }
+
+        return;
+    }
+
+    // Ballistics: target + cte * (gain - target), attack while rising and release while falling.
+    // Written as target * (1 - cte) + cte * gain for both constants, the faster constant's step is the higher one
+    // while rising and the lower one while falling. So max picks each lane's step, or min if the release is the
+    // faster, and the recursion doesn't wait on a compare.
+    const auto attackRegister  = Register::expand (cteAttack);
+    const auto releaseRegister = Register::expand (cteRelease);
+    const auto attackComplementRegister  = Register::expand (static_cast<SampleType> (1.0) - cteAttack);
+    const auto releaseComplementRegister = Register::expand (static_cast<SampleType> (1.0) - cteRelease);
+    const auto lastTarget = gainRegisters[numSamples - 1];
+
+    auto gain = state[kGain];
+
+    const auto smooth = [&] (auto pick)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto target = gainRegisters[i];
+
+            gain = pick (Register::multiplyAdd (target * attackComplementRegister,  attackRegister,  gain),
+                         Register::multiplyAdd (target * releaseComplementRegister, releaseRegister, gain));
+            gainRegisters[i] = gain;
+        }
+    };
+
+    if (cteAttack <= cteRelease)
+        smooth ([] (Register rise, Register fall) { return Register::max (rise, fall); });
+    else
+        smooth ([] (Register rise, Register fall) { return Register::min (rise, fall); });
+
+    // Snap each lane once close enough, so a steady gate reaches the fast path above
+    const auto settled = Register::lessThan (Register::abs (gain - lastTarget), Register::expand (settledLog2));
+    state[kGain] = (lastTarget & settled) + (gain & ~settled);
+
+    // Linear gain and VCA, a channel at a time
+    for (auto channel = firstChannel; channel < endChannel; ++channel)
+    {
+        const auto lane = channel - firstChannel;
+
+        for (int i = 0; i < numSamples; ++i)
+            channelValues[i] = gains[(size_t) i * registerSize + lane];
+
+        for (int i = 0; i < numSamples; ++i)
+            channelValues[i] = static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (channelValues[i])));
+
+        juce::FloatVectorOperations::multiply (output.getChannelPointer (channel), channelValues, numSamples);
+    }
+}
+
+template <typename SampleType>
+void Expander<SampleType>::processChannel (size_t channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+{
+    // Found before the delay, as input and output may alias
+    SettledRuns runs;
+
+    if (findSettledRuns (channel, input, numSamples, runs))
+    {
+        if (output != input)
+            juce::FloatVectorOperations::copy (output, input, numSamples);
+
+        lookahead.processDelay ((int) channel, output, numSamples);
+        applySettledRuns (channel, runs, output);
+        return;
+    }
+
+    // The scratch rows, read as plain samples
+    auto* levels = reinterpret_cast<SampleType*> (scratch.getChannelPointer (kLevels));
+    auto* gains  = reinterpret_cast<SampleType*> (scratch.getChannelPointer (kGains));
+
+    // Detector: rectify and take the level in log2 units, ahead of the lookahead delay
+    for (int i = 0; i < numSamples; ++i)
+        levels[i] = static_cast<SampleType> (viator_utils::FastMath::fastLog2 (static_cast<float> (std::abs (input[i]))));
+
+    // Gain curve in log2 units
+    applyGainCurve (levels, gains, numSamples);
+
+    // The channel's lane of its group's state, kept local through the loops
+    auto* state = reinterpret_cast<SampleType*> (gateState.getChannelPointer (channel / registerSize));
+    const auto lane = channel % registerSize;
+
+    auto gain = state[kGain * registerSize + lane];
+    auto hold = state[kHold * registerSize + lane];
+
+    // The gate's target: unity while open. Without hysteresis or hold that is already the curve.
+    if (closeThresholdLog2 < thresholdLog2 || holdSamples > 0)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            gains[i] = stepGate (hold, levels[i], gains[i]);
+
+        state[kHold * registerSize + lane] = hold;
+    }
+
+    // Audio path is delayed by the same lookahead so it meets the held peak
+    if (output != input)
+        juce::FloatVectorOperations::copy (output, input, numSamples);
+
+    lookahead.processDelay ((int) channel, output, numSamples);
+
+    // A gate settled open, or closed at the range, holds one gain for the whole chunk.
+    // That skips the ballistics recursion, the exp2 pass and, while open, the VCA.
+    const auto targets = juce::FloatVectorOperations::findMinAndMax (gains, numSamples);
+
+    if (targets.getStart() == targets.getEnd() && targets.getStart() == gain)
+    {
+        if (gain < static_cast<SampleType> (0.0))
+            juce::FloatVectorOperations::multiply (output, static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain))), numSamples);
+
+        return;
+    }
+
+    // Ballistics, the only recursion
+    const auto lastTarget = gains[numSamples - 1];
+
+    for (int i = 0; i < numSamples; ++i)
+        gains[i] = smoothGain (gain, gains[i]);
+
+    // Snap once close enough, so a steady gate reaches the fast path above
+    state[kGain * registerSize + lane] = std::abs (gain - lastTarget) < settledLog2 ? lastTarget : gain;
+
+    // Linear gain
+    for (int i = 0; i < numSamples; ++i)
+        gains[i] = static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gains[i])));
+
+    // VCA
+    juce::FloatVectorOperations::multiply (output, gains, numSamples);
+}
+
+template <typename SampleType>
+bool Expander<SampleType>::findSettledRuns (size_t channel, const SampleType* input, int numSamples, SettledRuns& runs) const noexcept
+{
+    const auto* state = reinterpret_cast<const SampleType*> (gateState.getChannelPointer (channel / registerSize));
+    const auto stateHold = state[kHold * registerSize + channel % registerSize];
+    const auto gateEnabled = closeThresholdLog2 < thresholdLog2 || holdSamples > 0;
+
+    // Magnitudes compare against the thresholds' magnitudes exactly as their levels would against the thresholds
+    const auto magnitude = [input] (int i) { return static_cast<float> (std::abs (input[i])); };
+
+    auto hold = gateEnabled ? (int) stateHold : 0;
+    runs.numRuns = 0;
+
+    for (int start = 0, end = 0; start < numSamples; start = end)
+    {
+        auto target = static_cast<SampleType> (0.0);
+
+        if (hold == 0)
+        {
+            // Closed: below the knee the curve sits at the range, up to the first level that opens the gate
+            const auto peak = juce::FloatVectorOperations::findMinAndMax (input + start, numSamples - start);
 
-    // Output
-    return gain * inputValue;
+            if (static_cast<float> (juce::jmax (-peak.getStart(), peak.getEnd())) < kneeMagnitude)
+            {
+                end = numSamples;
+            }
+            else
+            {
+                while (end < numSamples && magnitude (end) < kneeMagnitude)
+                    ++end;
+
+                if (! gateEnabled || end == numSamples || magnitude (end) < thresholdMagnitude)
+                    return false;
+
+                // The open run reloads the hold on this sample
+                hold = 1;
+            }
+
+            target = rangeLog2;
+        }
+        else if (holdSamples >= numSamples)
+        {
+            // Open, with a hold longer than the chunk: it can only run out before the first sample above the
+            // hysteresis reloads it, and after that only the last reload matters
+            while (end < numSamples && magnitude (end) < closeThresholdMagnitude)
+                ++end;
+
+            if (end - start >= hold)
+            {
+                end = start + hold - 1;
+                hold = 0;
+            }
+            else if (end == numSamples)
+            {
+                hold -= numSamples - start;
+            }
+            else
+            {
+                auto last = numSamples - 1;
+
+                while (magnitude (last) < closeThresholdMagnitude)
+                    --last;
+
+                end = numSamples;
+                hold = holdSamples + 1 - (numSamples - 1 - last);
+            }
+        }
+        else
+        {
+            // Open: every sample above the hysteresis reloads the hold, and the gate closes on the sample it runs out
+            for (; end < numSamples; ++end)
+            {
+                hold = magnitude (end) >= closeThresholdMagnitude ? holdSamples + 1 : hold - 1;
+
+                if (hold == 0)
+                    break;
+            }
+        }
+
+        // A gate that opens or closes on the run's first sample leaves it empty
+        if (end == start)
+            continue;
+
+        if (runs.numRuns == maximumRuns)
+            return false;
+
+        runs.ends[(size_t) runs.numRuns]    = end;
+        runs.targets[(size_t) runs.numRuns] = target;
+        ++runs.numRuns;
+    }
+
+    runs.hold = gateEnabled ? static_cast<SampleType> (hold) : stateHold;
+    return true;
+}
+
+template <typename SampleType>
+void Expander<SampleType>::applySettledRuns (size_t channel, const SettledRuns& runs, SampleType* output) noexcept
+{
+    auto* gains = reinterpret_cast<SampleType*> (scratch.getChannelPointer (kGains));
+    auto* state = reinterpret_cast<SampleType*> (gateState.getChannelPointer (channel / registerSize));
+    const auto lane = channel % registerSize;
+
+    auto gain = state[kGain * registerSize + lane];
+
+    for (int run = 0, start = 0; run < runs.numRuns; start = runs.ends[(size_t) run++])
+    {
+        const auto end    = runs.ends[(size_t) run];
+        const auto target = runs.targets[(size_t) run];
+        const auto length = end - start;
+
+        // Settled: one gain for the whole run, and no VCA while open
+        if (gain == target)
+        {
+            if (gain < static_cast<SampleType> (0.0))
+                juce::FloatVectorOperations::multiply (output + start, static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gain))), length);
+
+            continue;
+        }
+
+        // A steady target is approached from one side, with one constant: target + cte^(n + 1) * (gain - target)
+        const auto* powers = target > gain ? attackPowers.data() : releasePowers.data();
+        const auto distance = gain - target;
+
+        for (int i = 0; i < length; ++i)
+            gains[start + i] = target + powers[i] * distance;
+
+        gain = gains[end - 1];
+
+        for (int i = start; i < end; ++i)
+            gains[i] = static_cast<SampleType> (viator_utils::FastMath::fastExp2 (static_cast<float> (gains[i])));
+
+        juce::FloatVectorOperations::multiply (output + start, gains + start, length);
+    }
+
+    // Snap once close enough, as in processChannel()
+    const auto lastTarget = runs.targets[(size_t) runs.numRuns - 1];
+
+    state[kGain * registerSize + lane] = std::abs (gain - lastTarget) < settledLog2 ? lastTarget : gain;
+    state[kHold * registerSize + lane] = runs.hold;
+}
+
+template <typename SampleType>
+template <typename Predicate>
+float Expander<SampleType>::findMagnitude (Predicate reaches) noexcept
+{
+    const auto toFloat = [] (uint32_t bits)
+    {
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    };
+
+    // fastLog2 never falls as the magnitude grows, so bisect over the positive floats' bit patterns
+    uint32_t low = 0, high = 0x7f800000u;
+
+    while (low < high)
+    {
+        const auto middle = low + (high - low) / 2;
+
+        if (reaches (static_cast<SampleType> (viator_utils::FastMath::fastLog2 (toFloat (middle)))))
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return toFloat (low);
+}
+
+template <typename SampleType>
+void Expander<SampleType>::applyGainCurve (const SampleType* levels, SampleType* gains, int numSamples) const noexcept
+{
+    using SIMD = juce::dsp::SIMDRegister<SampleType>;
+
+    const auto simdSize = (int) SIMD::size();
+
+    const auto thresholdRegister = SIMD::expand (thresholdLog2);
+    const auto slopeRegister     = SIMD::expand (slope);
+    const auto rangeRegister     = SIMD::expand (rangeLog2);
+    const auto zeroRegister      = SIMD::expand (static_cast<SampleType> (0.0));
+
+    int i = 0;
+
+    // Only the aligned scratch buffers are long enough to reach the register loop
+    for (; i + simdSize <= numSamples; i += simdSize)
+    {
+        const auto level = SIMD::fromRawArray (levels + i);
+        SIMD::max (rangeRegister, SIMD::min (zeroRegister, (level - thresholdRegister) * slopeRegister)).copyToRawArray (gains + i);
+    }
+
+    for (; i < numSamples; ++i)
+        gains[i] = juce::jlimit (rangeLog2, static_cast<SampleType> (0.0), (levels[i] - thresholdLog2) * slope);
+}
+
+template <typename SampleType>
+SampleType Expander<SampleType>::stepGate (SampleType& hold, SampleType level, SampleType closedGain) const noexcept
+{
+    // The same steps as the gate pass in processGroup(), one lane at a time
+    const auto reopen = level >= thresholdLog2 || (hold > static_cast<SampleType> (0.0) && level >= closeThresholdLog2);
+
+    hold = reopen ? static_cast<SampleType> (holdSamples + 1) : juce::jmax (hold - static_cast<SampleType> (1.0), static_cast<SampleType> (0.0));
+
+    return hold > static_cast<SampleType> (0.0) ? static_cast<SampleType> (0.0) : closedGain;
+}
+
+template <typename SampleType>
+SampleType Expander<SampleType>::smoothGain (SampleType& gain, SampleType target) const noexcept
+{
+    // Ballistics on the log2 gain: attack while opening, release while closing
+    const auto cte = target > gain ? cteAttack : cteRelease;
+    gain = target + cte * (gain - target);
+
+    return gain;
 }
 
 template <typename SampleType>
 void Expander<SampleType>::update()
 {
-    threshold = juce::Decibels::decibelsToGain (thresholddB, static_cast<SampleType> (-200.0));
-    thresholdInverse = static_cast<SampleType> (1.0) / threshold;
-    ratioInverse     = static_cast<SampleType> (1.0) / ratio;
+    constexpr auto log2PerDecibel = 0.16609640474436813; // log2 (10) / 20
+
+    thresholdLog2      = static_cast<SampleType> (thresholddB * log2PerDecibel);
+    closeThresholdLog2 = static_cast<SampleType> ((thresholddB - hysteresisdB) * log2PerDecibel);
+    rangeLog2          = static_cast<SampleType> (rangedB * log2PerDecibel);
+    slope              = ratio - static_cast<SampleType> (1.0);
+
+    // Hold at least through the lookahead, so the delayed audio has left before the gate closes
+    holdSamples = juce::jmax (juce::roundToInt (holdTime * 0.001 * sampleRate), lookahead.getDelay());
+
+    // Same time constants as juce::dsp::BallisticsFilter
+    cteAttack  = attackTime  < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / attackTime));
+    cteRelease = releaseTime < static_cast<SampleType> (1.0e-3) ? static_cast<SampleType> (0.0)
+                                                                 : static_cast<SampleType> (std::exp (expFactor / releaseTime));
+
+    auto attackPower = 1.0, releasePower = 1.0;
 
-    envelopeFilter.setAttackTime (attackTime);
-    envelopeFilter.setReleaseTime (releaseTime);
+    for (size_t i = 0; i < attackPowers.size(); ++i)
+    {
+        attackPowers[i]  = static_cast<SampleType> (attackPower  *= (double) cteAttack);
+        releasePowers[i] = static_cast<SampleType> (releasePower *= (double) cteRelease);
+    }
+
+    // The gate's decisions and the knee, below which the curve sits at the range, as magnitudes
+    thresholdMagnitude      = findMagnitude ([this] (SampleType level) { return level >= thresholdLog2; });
+    closeThresholdMagnitude = findMagnitude ([this] (SampleType level) { return level >= closeThresholdLog2; });
+    kneeMagnitude           = findMagnitude ([this] (SampleType level) { return juce::jmin (static_cast<SampleType> (0.0), (level - thresholdLog2) * slope) > rangeLog2; });
 }
 
 #pragma mark Setters
@@ -65,7 +587,7 @@ void Expander<SampleType>::setThreshold (SampleType newThreshold)
 template <typename SampleType>
 void Expander<SampleType>::setRatio (SampleType newRatio)
 {
-    jassert (newRatio <= static_cast<SampleType> (1.0));
+    jassert (newRatio >= static_cast<SampleType> (1.0));
 
     ratio = newRatio;
     update();
@@ -85,6 +607,43 @@ void Expander<SampleType>::setRelease (SampleType newRelease)
     update();
 }
 
+template <typename SampleType>
+void Expander<SampleType>::setHysteresis (SampleType newHysteresis)
+{
+    jassert (newHysteresis >= static_cast<SampleType> (0.0));
+
+    hysteresisdB = newHysteresis;
+    update();
+}
+
+template <typename SampleType>
+void Expander<SampleType>::setHold (SampleType newHold)
+{
+    jassert (newHold >= static_cast<SampleType> (0.0));
+
+    holdTime = newHold;
+    update();
+}
+
+template <typename SampleType>
+void Expander<SampleType>::setRange (SampleType newRange)
+{
+    jassert (newRange <= static_cast<SampleType> (0.0));
+
+    rangedB = newRange;
+    update();
+}
+
+template <typename SampleType>
+void Expander<SampleType>::setLookahead (SampleType newLookahead)
+{
+    jassert (newLookahead >= static_cast<SampleType> (0.0) && newLookahead <= static_cast<SampleType> (maximumLookaheadMs));
+
+    lookaheadTime = newLookahead;
+    lookahead.setDelay (juce::roundToInt (lookaheadTime * 0.001 * sampleRate));
+    update();
+}
+
 } // namespace viator_dsp
 
 template class viator_dsp::Expander<float>;
@@ -2,22 +2,77 @@
 #define Expander_h
 
 #include "../Common/Common.h"
+#include "LookaheadDelay.h"
 
 namespace viator_dsp
 {
 
+/**
+    Downward expander and gate, with the gain computed in the log domain.
+
+    Each block goes through passes over a scratch buffer, as in Compressor:
+
+        rectify -> log2 level -> gain curve -> gate -> ballistics -> exp2 -> apply
+
+    The level and gain are in log2 units. Below the threshold the curve falls by
+    (ratio - 1) units per unit, down to the range. The log/exp passes use
+    FastMath::fastLog2/fastExp2 and the curve runs on juce::dsp::SIMDRegister, so
+    there is no pow() per sample.
+
+    The gate opens when the level reaches the threshold. Once open, it stays
+    open until the level falls below the threshold minus the hysteresis and the
+    hold time has run out. While open the gain is unity; while closed it follows
+    the curve. With no hysteresis or hold it is a plain expander and the gate
+    pass is skipped. The attack and release smooth the gain in the log domain, so
+    the gate opens over the attack time and closes over the release time. A hold
+    that covers the lowest half period keeps the gate from dipping at zero
+    crossings.
+
+    Channels are interleaved into juce::dsp::SIMDRegisters, as in SVFilterBank,
+    so the gate and ballistics recursions step a whole group of channels at
+    once, each lane picking attack or release on its own. A lone channel, as in
+    a mono gate, runs the same passes on scalars. Once the gain has settled,
+    fully open or closed at the range, a whole chunk needs one gain per channel,
+    so the ballistics and exp2 passes are skipped, and while open so is the VCA.
+
+    Most of a gated drum's chunks never touch the slope of the curve: the gate
+    is open, or closed with every level below the knee where the curve meets
+    the range. Those chunks take a settled path that skips the log2 and gain
+    curve passes. The gate is decided on magnitudes, compared against the
+    smallest magnitudes whose fastLog2 levels reach the thresholds, so it opens
+    and closes on the same samples as the full path. Each run of one target is
+    smoothed in closed form from a table of the attack or release constant's
+    powers, so there is no recursion either. Only a chunk with a level on the
+    slope, as in a plain expander, runs the full passes.
+
+    The lookahead delays the audio through the same LookaheadDelay as
+    Compressor, while the detector hears the signal undelayed, so the gate is
+    already open when a transient arrives. The hold is stretched to at least the
+    lookahead, so the gate stays open until the delayed transient has passed.
+    The delay is reported through getLatencySamples().
+
+    Breaking change: the ratio convention is not the one the per-sample Expander
+    used. That took a ratio of 1 or below, expanded by 1 / ratio below the
+    threshold and boosted by the same slope above it. setRatio() now takes the
+    downward slope itself, 1 or above, and the gain stays at unity above the
+    threshold. To port a setting, pass 1 / ratio; upward expansion above the
+    threshold is gone.
+*/
 template <typename SampleType>
 class Expander
 {
 public:
-    
+
     /** Constructor. */
     Expander();
 
     /** Sets the threshold in dB of the expander.*/
     void setThreshold (SampleType newThreshold);
 
-    /** Sets the ratio of the expander (must be higher or equal to 1).*/
+    /** Sets the ratio of the expander (must be higher or equal to 1). Below the threshold
+        the output falls ratio dB per dB of input. This is the inverse of the old
+        convention, see the class notes.
+    */
     void setRatio (SampleType newRatio);
 
     /** Sets the attack time in milliseconds of the expander.*/
@@ -26,7 +81,24 @@ public:
     /** Sets the release time in milliseconds of the expander.*/
     void setRelease (SampleType newRelease);
 
-    /** Initialises the processor. */
+    /** Sets how many dB below the threshold the level must fall before the gate closes.*/
+    void setHysteresis (SampleType newHysteresis);
+
+    /** Sets how long in milliseconds the gate stays open after the level falls below the hysteresis, at least the lookahead.*/
+    void setHold (SampleType newHold);
+
+    /** Sets the deepest attenuation in dB, 0 or below.*/
+    void setRange (SampleType newRange);
+
+    /** Sets the lookahead time in milliseconds, between 0 and maximumLookaheadMs.*/
+    void setLookahead (SampleType newLookahead);
+
+    /** Returns the latency added by the lookahead, in samples. */
+    int getLatencySamples() const noexcept { return lookahead.getDelay(); }
+
+    static constexpr double maximumLookaheadMs = 20.0;
+
+    /** Initialises the processor. Allocates the scratch buffers, so call it off the audio thread. */
     void prepare (const juce::dsp::ProcessSpec& spec);
 
     /** Resets the internal state variables of the processor. */
@@ -43,20 +115,26 @@ public:
 
         jassert (inputBlock.getNumChannels() == numChannels);
         jassert (inputBlock.getNumSamples()  == numSamples);
+        jassert (numChannels <= gateState.getNumChannels() * registerSize);
 
         if (context.isBypassed)
         {
+            // Still run the delay so the reported latency holds while bypassed
             outputBlock.copyFrom (inputBlock);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                lookahead.processDelay ((int) channel, outputBlock.getChannelPointer (channel), (int) numSamples);
+
             return;
         }
 
-        for (size_t channel = 0; channel < numChannels; ++channel)
+        // Hosts may send more than maximumBlockSize, so walk the block in scratch-sized chunks
+        for (size_t start = 0; start < numSamples; start += maximumBlockSize)
         {
-            auto* inputSamples  = inputBlock .getChannelPointer (channel);
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
+            const auto length = juce::jmin (maximumBlockSize, numSamples - start);
 
-            for (size_t i = 0; i < numSamples; ++i)
-                outputSamples[i] = processSample ((int) channel, inputSamples[i]);
+            for (size_t group = 0; group * registerSize < numChannels; ++group)
+                processGroup (group, inputBlock.getSubBlock (start, length), outputBlock.getSubBlock (start, length));
         }
     }
 
@@ -64,17 +142,101 @@ public:
     SampleType processSample (int channel, SampleType inputValue);
 
 private:
-    juce::dsp::BallisticsFilter<SampleType> envelopeFilter;
-    
-private:
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr size_t registerSize = Register::SIMDNumElements;
+
+    /** The scratch rows: a channel group's levels and gains, one register per sample frame,
+        then one channel's samples packed contiguously
+    */
+    enum ScratchRowId
+    {
+        kLevels,
+        kGains,
+        kChannel,
+        kNumScratchRows
+    };
+
+    /** The registers of a group's gate state, one lane per channel: the smoothed log2 gain,
+        then the samples the gate stays open for, which is above 0 exactly while it is open
+    */
+    enum StateId
+    {
+        kGain,
+        kHold,
+        kNumStates
+    };
+
     void update();
 
+    /** Runs every pass for channel group group. input and output may alias. */
+    void processGroup (size_t group, const juce::dsp::AudioBlock<const SampleType>& input, const juce::dsp::AudioBlock<SampleType>& output) noexcept;
+
+    /** Runs every pass for channel alone, on its lane of its group's state. input and output may alias. */
+    void processChannel (size_t channel, const SampleType* input, SampleType* output, int numSamples) noexcept;
+
+    /** Turns log2 levels into the closed gate's log2 gains. */
+    void applyGainCurve (const SampleType* levels, SampleType* gains, int numSamples) const noexcept;
+
+    /** Steps the gate by one sample and returns its target log2 gain: 0 while open, closedGain while closed. */
+    SampleType stepGate (SampleType& hold, SampleType level, SampleType closedGain) const noexcept;
+
+    /** Steps the attack/release smoothing towards target and returns the smoothed log2 gain. */
+    SampleType smoothGain (SampleType& gain, SampleType target) const noexcept;
+
+    /** The most runs a chunk may split into and still take the settled path */
+    static constexpr int maximumRuns = 4;
+
+    /** A chunk split into runs over which the gate's target holds still, and the hold left after it */
+    struct SettledRuns
+    {
+        std::array<int, maximumRuns> ends;
+        std::array<SampleType, maximumRuns> targets;
+        int numRuns = 0;
+        SampleType hold = 0;
+    };
+
+    /** Splits channel's chunk into runs open at unity or closed at the range, deciding the gate on
+        magnitudes alone. Returns false if a level lands on the slope of the curve or there are too many runs.
+    */
+    bool findSettledRuns (size_t channel, const SampleType* input, int numSamples, SettledRuns& runs) const noexcept;
+
+    /** Smooths each run's gain in closed form and applies it. output must already be delayed. */
+    void applySettledRuns (size_t channel, const SettledRuns& runs, SampleType* output) noexcept;
+
+    /** The smallest magnitude whose fastLog2 level satisfies reaches, so comparing against it decides as the levels would. */
+    template <typename Predicate>
+    static float findMagnitude (Predicate reaches) noexcept;
+
+    /** How close in log2 units (0.006 dB) the smoothed gain must get to a steady target to snap onto it */
+    static constexpr SampleType settledLog2 = static_cast<SampleType> (1.0e-3);
+
+private:
+    juce::HeapBlock<char> scratchData;
+    juce::dsp::AudioBlock<Register> scratch;
+    size_t maximumBlockSize = 0;
+
+    /** One row per channel group */
+    juce::HeapBlock<char> gateStateData;
+    juce::dsp::AudioBlock<Register> gateState;
+
+    LookaheadDelay<SampleType> lookahead;
+
 private:
-    SampleType threshold, thresholdInverse, ratioInverse;
+    SampleType thresholdLog2, closeThresholdLog2, rangeLog2, slope, cteAttack, cteRelease;
+    int holdSamples = 0;
+
+    /** The threshold, hysteresis and the curve's knee onto the range, as magnitudes */
+    float thresholdMagnitude = 0.0f, closeThresholdMagnitude = 0.0f, kneeMagnitude = 0.0f;
+
+    /** cteAttack and cteRelease to the powers 1 to maximumBlockSize, for the settled path */
+    std::vector<SampleType> attackPowers, releasePowers;
 
     double sampleRate = 44100.0;
-    
+    double expFactor = 0.0;
+
     SampleType thresholddB = 0.0, ratio = 1.0, attackTime = 1.0, releaseTime = 100.0;
+    SampleType hysteresisdB = 0.0, holdTime = 0.0, rangedB = -120.0, lookaheadTime = 0.0;
 };
 
 } // namespace viator_dsp
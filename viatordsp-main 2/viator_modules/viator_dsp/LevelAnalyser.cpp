@@ -0,0 +1,80 @@
+#include "LevelAnalyser.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+BlockLevels<SampleType> LevelAnalyser<SampleType>::analyse (const SampleType* data, int numSamples) noexcept
+{
+    using SIMD = juce::dsp::SIMDRegister<SampleType>;
+
+    BlockLevels<SampleType> levels;
+    levels.numSamples = juce::jmax (0, numSamples);
+
+    if (numSamples <= 0)
+        return levels;
+
+    auto minimum = data[0];
+    auto maximum = data[0];
+    auto sum = static_cast<SampleType> (0.0);
+    auto sumOfSquares = static_cast<SampleType> (0.0);
+
+    auto accumulate = [&] (SampleType sample)
+    {
+        minimum = juce::jmin (minimum, sample);
+        maximum = juce::jmax (maximum, sample);
+        sum += sample;
+        sumOfSquares += sample * sample;
+    };
+
+    // Scalar head up to the first aligned sample
+    int i = 0;
+
+    for (; i < numSamples && ! SIMD::isSIMDAligned (data + i); ++i)
+        accumulate (data[i]);
+
+    const auto simdSize = (int) SIMD::size();
+
+    if (i + simdSize <= numSamples)
+    {
+        auto minimumRegister      = SIMD::expand (minimum);
+        auto maximumRegister      = SIMD::expand (maximum);
+        auto sumRegister          = SIMD::expand (static_cast<SampleType> (0.0));
+        auto sumOfSquaresRegister = SIMD::expand (static_cast<SampleType> (0.0));
+
+        for (; i + simdSize <= numSamples; i += simdSize)
+        {
+            const auto samples = SIMD::fromRawArray (data + i);
+
+            minimumRegister       = SIMD::min (minimumRegister, samples);
+            maximumRegister       = SIMD::max (maximumRegister, samples);
+            sumRegister          += samples;
+            sumOfSquaresRegister += samples * samples;
+        }
+
+        for (size_t lane = 0; lane < SIMD::size(); ++lane)
+        {
+            minimum = juce::jmin (minimum, minimumRegister.get (lane));
+            maximum = juce::jmax (maximum, maximumRegister.get (lane));
+        }
+
+        sum          += sumRegister.sum();
+        sumOfSquares += sumOfSquaresRegister.sum();
+    }
+
+    // Scalar tail
+    for (; i < numSamples; ++i)
+        accumulate (data[i]);
+
+    levels.minimum = minimum;
+    levels.maximum = maximum;
+    levels.sum = sum;
+    levels.sumOfSquares = sumOfSquares;
+
+    return levels;
+}
+
+} // namespace viator_dsp
+
+template class viator_dsp::LevelAnalyser<float>;
+template class viator_dsp::LevelAnalyser<double>;
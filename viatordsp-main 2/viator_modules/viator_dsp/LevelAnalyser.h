@@ -0,0 +1,58 @@
+#ifndef LevelAnalyser_h
+#define LevelAnalyser_h
+
+#include "../Common/Common.h"
+
+namespace viator_dsp
+{
+
+/** Statistics of one channel over one block. */
+template <typename SampleType>
+struct BlockLevels
+{
+    SampleType minimum = 0;
+    SampleType maximum = 0;
+    SampleType sum = 0;
+    SampleType sumOfSquares = 0;
+    int numSamples = 0;
+
+    SampleType getPeak() const noexcept { return juce::jmax (-minimum, maximum); }
+
+    SampleType getMean() const noexcept
+    {
+        return numSamples > 0 ? sum / static_cast<SampleType> (numSamples) : static_cast<SampleType> (0.0);
+    }
+
+    SampleType getRms() const noexcept
+    {
+        return numSamples > 0 ? std::sqrt (sumOfSquares / static_cast<SampleType> (numSamples)) : static_cast<SampleType> (0.0);
+    }
+};
+
+/**
+    Fused metering kernel: min, max, sum and sum of squares of a channel in one
+    read of the data, so peak, RMS and DC all come from a single memory pass
+    instead of a getMagnitude() plus getRMSLevel() pair per channel.
+
+    The body runs on juce::dsp::SIMDRegister with a scalar head and tail, so it
+    works on unaligned host buffers.
+*/
+template <typename SampleType>
+class LevelAnalyser
+{
+public:
+
+    /** Measures a single channel. */
+    static BlockLevels<SampleType> analyse (const SampleType* data, int numSamples) noexcept;
+
+    /** Measures every channel of a block, writing one result per channel. */
+    static void analyse (const juce::dsp::AudioBlock<const SampleType>& block, BlockLevels<SampleType>* results) noexcept
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            results[channel] = analyse (block.getChannelPointer (channel), (int) block.getNumSamples());
+    }
+};
+
+} // namespace viator_dsp
+
+#endif /* LevelAnalyser_h */
@@ -0,0 +1,474 @@
+#include "LinearPhaseCrossover.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+
+    numChannels = spec.numChannels;
+
+    ffts.clear();
+
+    for (int size = minPartitionSize; size <= maxPartitionSize; size *= 2)
+        ffts.push_back (std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (size * 2))));
+
+    for (auto& set : filterSets)
+    {
+        set.real.assign ((size_t) (maxBands * maxSpectrumSize), 0.0f);
+        set.imag.assign ((size_t) (maxBands * maxSpectrumSize), 0.0f);
+        set.numBands = 0;
+    }
+
+    delayLineReal.assign (numChannels * maxSpectrumSize, 0.0f);
+    delayLineImag.assign (numChannels * maxSpectrumSize, 0.0f);
+
+    inputFifo.assign (numChannels * maxPartitionSize, 0.0f);
+    previousInput.assign (numChannels * maxPartitionSize, 0.0f);
+    outputFifo.assign (maxBands * numChannels * maxPartitionSize, 0.0f);
+
+    // The real-only transforms need twice the FFT size, which is twice the partition
+    fftBuffer.assign ((size_t) (4 * maxPartitionSize), 0.0f);
+    accumulatorReal.assign ((size_t) (maxPartitionSize + 1), 0.0f);
+    accumulatorImag.assign ((size_t) (maxPartitionSize + 1), 0.0f);
+    fadeBuffer.assign ((size_t) maxPartitionSize, 0.0f);
+
+    window.assign ((size_t) maxPartitionSize, 0.0f);
+
+    setSampleRate (spec.sampleRate);
+
+    // Off the audio thread, so the first block already has real filters
+    designFilters();
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::reset()
+{
+    std::fill (delayLineReal.begin(), delayLineReal.end(), 0.0f);
+    std::fill (delayLineImag.begin(), delayLineImag.end(), 0.0f);
+    std::fill (inputFifo.begin(), inputFifo.end(), 0.0f);
+    std::fill (previousInput.begin(), previousInput.end(), 0.0f);
+    std::fill (outputFifo.begin(), outputFifo.end(), 0.0f);
+
+    fifoPosition = 0;
+    delayLinePosition = 0;
+    crossfadePending = false;
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::setSampleRate (double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+
+    // About 80 ms, so the lowest crossovers still get a steep slope
+    const auto length = juce::jlimit (juce::jmax (512, partitionSize), maxFilterLength,
+                                      juce::nextPowerOfTwo (juce::roundToInt (newSampleRate * 0.08)));
+    const auto unchanged = newSampleRate == sampleRate && length == filterLength && length / partitionSize == numPartitions;
+
+    sampleRate = newSampleRate;
+    filterLength = length;
+    numPartitions = filterLength / partitionSize;
+
+    // Before prepare() there's nowhere to put the filters yet; prepare() designs them itself
+    if (window.empty() || unchanged)
+        return;
+
+    // Both filter sets are laid out for the old length and partition size, so a running
+    // redesign is dropped and the next one is spread over process() like any other
+    reset();
+    useDelay();
+    designPartition = -1;
+    filtersNeedDesign = true;
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::setNumBands (int newNumBands)
+{
+    jassert (newNumBands >= 2 && newNumBands <= maxBands);
+
+    const auto bands = juce::jlimit (2, maxBands, newNumBands);
+
+    if (numBands != bands)
+    {
+        numBands = bands;
+        filtersNeedDesign = true;
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::setCrossoverFrequency (int index, SampleType newFrequency)
+{
+    jassert (index >= 0 && index < maxBands - 1);
+
+    if (crossoverFrequencies[(size_t) index] != newFrequency)
+    {
+        crossoverFrequencies[(size_t) index] = newFrequency;
+        filtersNeedDesign = true;
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::setPartitionSize (int newPartitionSize)
+{
+    jassert (juce::isPowerOfTwo (newPartitionSize));
+    jassert (newPartitionSize >= minPartitionSize && newPartitionSize <= maxPartitionSize);
+
+    const auto size = juce::jlimit (minPartitionSize, maxPartitionSize, juce::nextPowerOfTwo (newPartitionSize));
+
+    if (partitionSize != size)
+    {
+        partitionSize = size;
+
+        // The filter length can grow to stay a whole number of partitions
+        setSampleRate (sampleRate);
+    }
+}
+
+template <typename SampleType>
+juce::dsp::FFT& LinearPhaseCrossover<SampleType>::getFFT() noexcept
+{
+    const auto index = juce::roundToInt (std::log2 (partitionSize / minPartitionSize));
+    return *ffts[(size_t) index];
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::process (const juce::dsp::AudioBlock<const SampleType>& input, juce::dsp::AudioBlock<SampleType>* bands) noexcept
+{
+    const auto numInputChannels = input.getNumChannels();
+    const auto numSamples = input.getNumSamples();
+
+    jassert (numInputChannels <= numChannels);
+
+    if (filtersNeedDesign && designPartition < 0)
+        startDesign();
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        // Up to the end of the current partition
+        const auto length = juce::jmin (numSamples - start, (size_t) (partitionSize - fifoPosition));
+
+        for (size_t channel = 0; channel < numInputChannels; ++channel)
+        {
+            const auto* source = input.getChannelPointer (channel) + start;
+            auto* fifo = inputFifo.data() + channel * maxPartitionSize + fifoPosition;
+
+            for (size_t i = 0; i < length; ++i)
+                fifo[i] = (float) source[i];
+
+            // The previous partition's output, which is where the latency comes from
+            for (int band = 0; band < numBands; ++band)
+            {
+                const auto* output = outputFifo.data() + ((size_t) band * numChannels + channel) * maxPartitionSize + fifoPosition;
+                auto* destination = bands[band].getChannelPointer (channel) + start;
+
+                if (band < outputBands)
+                {
+                    for (size_t i = 0; i < length; ++i)
+                        destination[i] = (SampleType) output[i];
+                }
+                else
+                {
+                    std::fill (destination, destination + length, (SampleType) 0);
+                }
+            }
+
+            // Bands the filters have but the caller no longer asked for, until the new band count lands
+            auto* top = bands[numBands - 1].getChannelPointer (channel) + start;
+
+            for (int band = numBands; band < outputBands; ++band)
+            {
+                const auto* output = outputFifo.data() + ((size_t) band * numChannels + channel) * maxPartitionSize + fifoPosition;
+
+                for (size_t i = 0; i < length; ++i)
+                    top[i] += (SampleType) output[i];
+            }
+        }
+
+        fifoPosition += (int) length;
+        start += length;
+
+        if (fifoPosition == partitionSize)
+        {
+            processFrame (numInputChannels);
+            fifoPosition = 0;
+
+            // A finished redesign swaps in here, between partitions, and is faded in over the next one
+            if (designPartition >= 0 && designNextPartition())
+            {
+                activeSet = 1 - activeSet;
+                crossfadePending = true;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::processFrame (size_t numInputChannels) noexcept
+{
+    auto& fft = getFFT();
+    const auto numBins = partitionSize + 1;
+    const auto slotSize = (size_t) numBins;
+    const auto delayLineSize = (size_t) (numPartitions * numBins);
+
+    const auto& active = filterSets[(size_t) activeSet];
+    const auto& previousSet = filterSets[(size_t) (1 - activeSet)];
+
+    // While crossfading, every band either set has
+    outputBands = crossfadePending ? juce::jmax (active.numBands, previousSet.numBands) : active.numBands;
+
+    // Newest spectrum goes in front of the oldest
+    delayLinePosition = (delayLinePosition + numPartitions - 1) % numPartitions;
+
+    for (size_t channel = 0; channel < numInputChannels; ++channel)
+    {
+        auto* fifo = inputFifo.data() + channel * maxPartitionSize;
+        auto* previous = previousInput.data() + channel * maxPartitionSize;
+        auto* delayReal = delayLineReal.data() + channel * delayLineSize;
+        auto* delayImag = delayLineImag.data() + channel * delayLineSize;
+
+        // Overlap-save: the last two partitions of input, transformed once for every band
+        std::copy (previous, previous + partitionSize, fftBuffer.begin());
+        std::copy (fifo, fifo + partitionSize, fftBuffer.begin() + partitionSize);
+        std::copy (fifo, fifo + partitionSize, previous);
+
+        fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+        auto* slotReal = delayReal + (size_t) delayLinePosition * slotSize;
+        auto* slotImag = delayImag + (size_t) delayLinePosition * slotSize;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            slotReal[bin] = fftBuffer[(size_t) (2 * bin)];
+            slotImag[bin] = fftBuffer[(size_t) (2 * bin + 1)];
+        }
+
+        for (int band = 0; band < outputBands; ++band)
+        {
+            auto* output = outputFifo.data() + ((size_t) band * numChannels + channel) * maxPartitionSize;
+
+            if (band < active.numBands)
+                convolve (active, band, delayReal, delayImag, output);
+            else
+                std::fill (output, output + partitionSize, 0.0f);
+
+            if (! crossfadePending)
+                continue;
+
+            // The set that was just swapped out still has this partition, faded out linearly
+            if (band < previousSet.numBands)
+                convolve (previousSet, band, delayReal, delayImag, fadeBuffer.data());
+            else
+                std::fill (fadeBuffer.begin(), fadeBuffer.begin() + partitionSize, 0.0f);
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const auto fade = (float) (i + 1) / (float) partitionSize;
+                output[i] = fadeBuffer[(size_t) i] + fade * (output[i] - fadeBuffer[(size_t) i]);
+            }
+        }
+    }
+
+    crossfadePending = false;
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::convolve (const FilterSet& set, int band, const float* delayReal, const float* delayImag, float* output) noexcept
+{
+    auto& fft = getFFT();
+    const auto numBins = partitionSize + 1;
+    const auto slotSize = (size_t) numBins;
+
+    auto* accReal = accumulatorReal.data();
+    auto* accImag = accumulatorImag.data();
+
+    std::fill (accReal, accReal + numBins, 0.0f);
+    std::fill (accImag, accImag + numBins, 0.0f);
+
+    // Partition p of the filter meets the spectrum from p partitions ago
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto slot = (size_t) ((delayLinePosition + partition) % numPartitions);
+        const auto* xReal = delayReal + slot * slotSize;
+        const auto* xImag = delayImag + slot * slotSize;
+        const auto* hReal = set.real.data() + ((size_t) band * numPartitions + (size_t) partition) * slotSize;
+        const auto* hImag = set.imag.data() + ((size_t) band * numPartitions + (size_t) partition) * slotSize;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            accReal[bin] += xReal[bin] * hReal[bin] - xImag[bin] * hImag[bin];
+            accImag[bin] += xReal[bin] * hImag[bin] + xImag[bin] * hReal[bin];
+        }
+    }
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        fftBuffer[(size_t) (2 * bin)] = accReal[bin];
+        fftBuffer[(size_t) (2 * bin + 1)] = accImag[bin];
+    }
+
+    fft.performRealOnlyInverseTransform (fftBuffer.data());
+
+    // Only the second half is free of circular wrap-around
+    std::copy (fftBuffer.begin() + partitionSize, fftBuffer.begin() + 2 * partitionSize, output);
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::designFilters() noexcept
+{
+    startDesign();
+
+    while (! designNextPartition())
+    {
+    }
+
+    activeSet = 1 - activeSet;
+    outputBands = filterSets[(size_t) activeSet].numBands;
+    crossfadePending = false;
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::useDelay() noexcept
+{
+    auto& set = filterSets[(size_t) activeSet];
+
+    writeDelay (set.real.data(), set.imag.data());
+
+    set.numBands = 1;
+    outputBands = 1;
+    crossfadePending = false;
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::writeDelay (float* real, float* imag) noexcept
+{
+    const auto slotSize = (size_t) (partitionSize + 1);
+    const auto bandSize = (size_t) numPartitions * slotSize;
+    const auto centrePartition = (size_t) (filterLength / 2 / partitionSize);
+
+    std::fill (real, real + bandSize, 0.0f);
+    std::fill (imag, imag + bandSize, 0.0f);
+    std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    fftBuffer[(size_t) (filterLength / 2 % partitionSize)] = 1.0f;
+
+    getFFT().performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+    // Only the centre tap's own partition sees the impulse
+    for (size_t bin = 0; bin < slotSize; ++bin)
+    {
+        real[centrePartition * slotSize + bin] = fftBuffer[2 * bin];
+        imag[centrePartition * slotSize + bin] = fftBuffer[2 * bin + 1];
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover<SampleType>::startDesign() noexcept
+{
+    designFrequencies = crossoverFrequencies;
+    designNumBands = numBands;
+    designSums.fill (0.0);
+    designPartition = 0;
+    filtersNeedDesign = false;
+}
+
+template <typename SampleType>
+bool LinearPhaseCrossover<SampleType>::designNextPartition() noexcept
+{
+    auto& set = filterSets[(size_t) (1 - activeSet)];
+    const auto slotSize = (size_t) (partitionSize + 1);
+    const auto bandSize = (size_t) numPartitions * slotSize;
+    const auto numCrossovers = designNumBands - 1;
+
+    // Each low pass goes in the slot of the band below its crossover
+    if (designPartition < numPartitions)
+    {
+        auto& fft = getFFT();
+
+        // This partition's stretch of a Blackman window of filterLength + 1 points centred on filterLength / 2.
+        // Both ends are zero, so dropping the last one keeps the taps symmetric about the centre.
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * (designPartition * partitionSize + i) / filterLength;
+            window[(size_t) i] = (float) (0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase));
+        }
+
+        for (int crossover = 0; crossover < numCrossovers; ++crossover)
+        {
+            designSums[(size_t) crossover] += designLowPass (designFrequencies[(size_t) crossover], designPartition, fftBuffer.data());
+            std::fill (fftBuffer.begin() + partitionSize, fftBuffer.end(), 0.0f);
+
+            fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+            auto* hReal = set.real.data() + (size_t) crossover * bandSize + (size_t) designPartition * slotSize;
+            auto* hImag = set.imag.data() + (size_t) crossover * bandSize + (size_t) designPartition * slotSize;
+
+            for (size_t bin = 0; bin < slotSize; ++bin)
+            {
+                hReal[bin] = fftBuffer[2 * bin];
+                hImag[bin] = fftBuffer[2 * bin + 1];
+            }
+        }
+
+        ++designPartition;
+        return false;
+    }
+
+    // Band k is low pass k minus low pass k - 1, each scaled to unity at DC. Working down from the top,
+    // the low pass below is still in place when a band needs it.
+    for (int band = numCrossovers; band >= 0; --band)
+    {
+        auto* real = set.real.data() + (size_t) band * bandSize;
+        auto* imag = set.imag.data() + (size_t) band * bandSize;
+
+        if (band < numCrossovers)
+        {
+            const auto scale = (float) (1.0 / designSums[(size_t) band]);
+            juce::FloatVectorOperations::multiply (real, scale, (int) bandSize);
+            juce::FloatVectorOperations::multiply (imag, scale, (int) bandSize);
+        }
+        else
+        {
+            // The top band starts from a delayed impulse on the centre tap
+            writeDelay (real, imag);
+        }
+
+        if (band > 0)
+        {
+            const auto scale = (float) (-1.0 / designSums[(size_t) (band - 1)]);
+            juce::FloatVectorOperations::addWithMultiply (real, real - bandSize, scale, (int) bandSize);
+            juce::FloatVectorOperations::addWithMultiply (imag, imag - bandSize, scale, (int) bandSize);
+        }
+    }
+
+    set.numBands = designNumBands;
+    designPartition = -1;
+    return true;
+}
+
+template <typename SampleType>
+double LinearPhaseCrossover<SampleType>::designLowPass (SampleType frequency, int partition, float* taps) const noexcept
+{
+    const auto centre = filterLength / 2;
+    const auto cutoff = juce::jlimit (1.0e-4, 0.49, (double) frequency / sampleRate);
+    auto sum = 0.0;
+
+    // Windowed sinc
+    for (int i = 0; i < partitionSize; ++i)
+    {
+        const auto n = partition * partitionSize + i;
+        const auto x = (double) (n - centre);
+        const auto sinc = n == centre ? 2.0 * cutoff
+                                      : std::sin (juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+
+        taps[i] = (float) (sinc * window[(size_t) i]);
+        sum += taps[i];
+    }
+
+    return sum;
+}
+
+} // namespace viator_dsp
+
+template class viator_dsp::LinearPhaseCrossover<float>;
+template class viator_dsp::LinearPhaseCrossover<double>;
@@ -0,0 +1,162 @@
+#ifndef LinearPhaseCrossover_h
+#define LinearPhaseCrossover_h
+
+#include "../Common/Common.h"
+
+namespace viator_dsp
+{
+
+/**
+    Linear-phase band splitter for MultiBandProcessor.
+
+    Each crossover is a windowed-sinc low pass with the same centre tap, and
+    band k is the difference of the low passes either side of it. The top band
+    is a delayed impulse minus the last low pass. The bands therefore add back
+    to a pure delay, with no phase shift at any crossover.
+
+    The band filters run as uniformly partitioned overlap-save convolution on
+    juce::dsp::FFT. Every partition size block of input gets one forward FFT
+    per channel, which goes into a frequency-domain delay line shared by all
+    bands. Each band then costs one multiply-accumulate over the delay line and
+    one inverse FFT. The multiply-accumulate works on split real/imaginary
+    arrays so it vectorises.
+
+    Latency is half the filter length plus one partition. Smaller partitions cut
+    the latency but cost more FFTs and delay line slots per sample. The filter
+    length follows the sample rate (about 80 ms, a power of two capped at
+    maxFilterLength). juce::dsp::FFT only works on float, so double input is
+    converted for the convolution.
+
+    A new crossover or band count doesn't redesign everything at once on the
+    audio thread. Each partition boundary designs one partition of every low
+    pass into a spare filter set, so a redesign lands about one filter length
+    after the change. The sets then swap between partitions, and the next
+    partition crossfades the old set's output into the new one's. Both read the
+    same delay line, so the crossfade costs one extra multiply-accumulate and
+    inverse FFT per band for that partition. Changes made while a redesign is
+    running are picked up by the next one.
+
+    A new rate or partition size clears the state and starts the same kind of
+    redesign, since neither filter set fits the new layout any more. Until it
+    lands the whole delayed input comes out of the lowest band, so the bands
+    still add back to the delayed input. Nothing is designed while process()
+    isn't called, so a splitter that isn't in use costs nothing to retune.
+*/
+template <typename SampleType>
+class LinearPhaseCrossover
+{
+public:
+
+    static constexpr int maxBands = 8;
+    static constexpr int minPartitionSize = 64;
+    static constexpr int maxPartitionSize = 1024;
+    static constexpr int maxFilterLength = 16384;
+
+    /** Allocates everything for any rate, partition size and band count, so call it off the audio thread. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    void reset();
+
+    /** Picks the filter length for a new rate, clears the state and starts a redesign. Doesn't allocate. */
+    void setSampleRate (double newSampleRate);
+
+    void setNumBands (int newNumBands);
+
+    /** Sets the crossover between band index and index + 1, in Hz. */
+    void setCrossoverFrequency (int index, SampleType newFrequency);
+
+    /** A power of two between minPartitionSize and maxPartitionSize. A new size clears the state and starts a redesign, like setSampleRate(). */
+    void setPartitionSize (int newPartitionSize);
+
+    /** Half the filter length plus one partition, in samples. */
+    int getLatencySamples() const noexcept { return filterLength / 2 + partitionSize; }
+
+    /**
+        Splits input into one block per band. bands points at getNumBands() blocks,
+        each with input's channel count and length.
+
+        While a new band count's filters are on their way, bands the current set
+        doesn't have are silent and those past getNumBands() go into the top one,
+        so the bands still add back to the delayed input. Never allocates.
+    */
+    void process (const juce::dsp::AudioBlock<const SampleType>& input, juce::dsp::AudioBlock<SampleType>* bands) noexcept;
+
+private:
+    static constexpr int maxPartitions = maxFilterLength / minPartitionSize;
+
+    /** The most complex bins one band's or one channel's partitions take, at the smallest partition size */
+    static constexpr int maxSpectrumSize = maxPartitions * (minPartitionSize + 1);
+
+    /** One complete set of partitioned band spectra: [band][partition][bin] */
+    struct FilterSet
+    {
+        std::vector<float> real, imag;
+        int numBands = 0;
+    };
+
+    /** Designs a whole filter set and switches to it without a crossfade, for when the state is cleared anyway */
+    void designFilters() noexcept;
+
+    /** Makes the active set a pure delay in the lowest band, for when the filters no longer fit the layout */
+    void useDelay() noexcept;
+
+    /** Writes a delayed impulse on the centre tap into one band's partitions */
+    void writeDelay (float* real, float* imag) noexcept;
+
+    /** Takes a copy of the settings and starts a redesign into the spare set */
+    void startDesign() noexcept;
+
+    /** Designs the next partition of every low pass. Once they're all done, turns them into bands and returns true. */
+    bool designNextPartition() noexcept;
+
+    /** Writes one partition of a windowed-sinc low pass, before normalisation, and returns the sum of its taps */
+    double designLowPass (SampleType frequency, int partition, float* taps) const noexcept;
+
+    void processFrame (size_t numInputChannels) noexcept;
+
+    /** One band of one channel through set, into partitionSize samples of output */
+    void convolve (const FilterSet& set, int band, const float* delayReal, const float* delayImag, float* output) noexcept;
+
+    juce::dsp::FFT& getFFT() noexcept;
+
+    /** One FFT per partition size, from minPartitionSize to maxPartitionSize */
+    std::vector<std::unique_ptr<juce::dsp::FFT>> ffts;
+
+    /** The set in use and the spare one redesigns go into */
+    std::array<FilterSet, 2> filterSets;
+    int activeSet = 0;
+
+    /** Frequency-domain delay line of input spectra: [channel][slot][bin] */
+    std::vector<float> delayLineReal, delayLineImag;
+
+    /** Time domain: [channel][sample] and [band][channel][sample] */
+    std::vector<float> inputFifo, previousInput, outputFifo;
+
+    std::vector<float> fftBuffer, accumulatorReal, accumulatorImag, fadeBuffer;
+    /** The window over the partition being designed */
+    std::vector<float> window;
+
+    std::array<SampleType, maxBands - 1> crossoverFrequencies {80, 250, 800, 2500, 5000, 9000, 14000};
+
+    /** The running redesign's settings, and its low passes' tap sums so far; designPartition is -1 when idle */
+    std::array<SampleType, maxBands - 1> designFrequencies {};
+    std::array<double, maxBands - 1> designSums {};
+    int designNumBands = 0;
+    int designPartition = -1;
+
+    double sampleRate = 44100.0;
+    size_t numChannels = 0;
+    int numBands = 4;
+    int filterLength = 4096;
+    int partitionSize = 256;
+    int numPartitions = 16;
+    int fifoPosition = 0;
+    int delayLinePosition = 0;
+    int outputBands = 0;
+    bool filtersNeedDesign = true;
+    bool crossfadePending = false;
+};
+
+} // namespace viator_dsp
+
+#endif /* LinearPhaseCrossover_h */
@@ -0,0 +1,159 @@
+#include "LookaheadDelay.h"
+
+namespace viator_dsp
+{
+
+template <typename SampleType>
+LookaheadDelay<SampleType>::LookaheadDelay()
+{
+}
+
+template <typename SampleType>
+void LookaheadDelay<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, int maximumDelayInSamples)
+{
+    jassert (spec.numChannels > 0);
+
+    maximumDelay = juce::jmax (0, maximumDelayInSamples);
+
+    const auto numChannels = (int) spec.numChannels;
+    const auto capacity = maximumDelay + 1;
+
+    // Room for a whole block past the delay, so processDelay() can write a block before reading it back
+    delayBuffer.setSize (numChannels, maximumDelay + juce::jmax (1, (int) spec.maximumBlockSize));
+    queueValues.setSize (numChannels, capacity);
+    queueIndices.assign ((size_t) numChannels, std::vector<juce::int64> ((size_t) capacity, 0));
+
+    writePositions.assign ((size_t) numChannels, 0);
+    queueFront.assign ((size_t) numChannels, 0);
+    queueSize.assign ((size_t) numChannels, 0);
+    sampleCounters.assign ((size_t) numChannels, 0);
+
+    setDelay (delay);
+    reset();
+}
+
+template <typename SampleType>
+void LookaheadDelay<SampleType>::reset()
+{
+    delayBuffer.clear();
+
+    std::fill (writePositions.begin(), writePositions.end(), 0);
+    std::fill (queueFront.begin(), queueFront.end(), 0);
+    std::fill (queueSize.begin(), queueSize.end(), 0);
+    std::fill (sampleCounters.begin(), sampleCounters.end(), 0);
+}
+
+template <typename SampleType>
+void LookaheadDelay<SampleType>::setDelay (int newDelayInSamples)
+{
+    delay = juce::jlimit (0, maximumDelay, newDelayInSamples);
+}
+
+template <typename SampleType>
+void LookaheadDelay<SampleType>::processDelay (int channel, SampleType* data, int numSamples) noexcept
+{
+    auto* line = delayBuffer.getWritePointer (channel);
+    const auto size = delayBuffer.getNumSamples();
+    auto writePosition = writePositions[(size_t) channel];
+
+    // Keep writing even with no delay so the line is already filled when lookahead is raised.
+    // Each chunk is copied in, then copied back out from delay samples earlier; the line
+    // holds delay + chunk samples, so the write never reaches anything still to be read.
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = juce::jmin (numSamples - start, size - delay);
+        auto* chunk = data + start;
+
+        const auto firstWrite = juce::jmin (length, size - writePosition);
+        juce::FloatVectorOperations::copy (line + writePosition, chunk, firstWrite);
+        juce::FloatVectorOperations::copy (line, chunk + firstWrite, length - firstWrite);
+
+        auto readPosition = writePosition - delay;
+
+        if (readPosition < 0)
+            readPosition += size;
+
+        const auto firstRead = juce::jmin (length, size - readPosition);
+        juce::FloatVectorOperations::copy (chunk, line + readPosition, firstRead);
+        juce::FloatVectorOperations::copy (chunk + firstRead, line, length - firstRead);
+
+        writePosition += length;
+
+        if (writePosition >= size)
+            writePosition -= size;
+
+        start += length;
+    }
+
+    writePositions[(size_t) channel] = writePosition;
+}
+
+template <typename SampleType>
+void LookaheadDelay<SampleType>::processPeakHold (int channel, SampleType* data, int numSamples) noexcept
+{
+    auto sampleIndex = sampleCounters[(size_t) channel];
+
+    if (delay == 0)
+    {
+        queueSize[(size_t) channel] = 0;
+        sampleCounters[(size_t) channel] = sampleIndex + numSamples;
+        return;
+    }
+
+    const auto capacity = queueValues.getNumSamples();
+    const auto window = delay + 1;
+
+    auto* values = queueValues.getWritePointer (channel);
+    auto* indices = queueIndices[(size_t) channel].data();
+    auto front = queueFront[(size_t) channel];
+    auto size = queueSize[(size_t) channel];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = data[i];
+
+        // Anything not louder than the new sample can never be the maximum again
+        while (size > 0)
+        {
+            auto back = front + size - 1;
+
+            if (back >= capacity)
+                back -= capacity;
+
+            if (values[back] > input)
+                break;
+
+            --size;
+        }
+
+        // Drop the front once it falls out of the window
+        while (size > 0 && indices[front] <= sampleIndex - window)
+        {
+            if (++front == capacity)
+                front = 0;
+
+            --size;
+        }
+
+        auto back = front + size;
+
+        if (back >= capacity)
+            back -= capacity;
+
+        values[back] = input;
+        indices[back] = sampleIndex;
+        ++size;
+
+        data[i] = values[front];
+        ++sampleIndex;
+    }
+
+    queueFront[(size_t) channel] = front;
+    queueSize[(size_t) channel] = size;
+    sampleCounters[(size_t) channel] = sampleIndex;
+}
+
+} // namespace viator_dsp
+
+template class viator_dsp::LookaheadDelay<float>;
+template class viator_dsp::LookaheadDelay<double>;
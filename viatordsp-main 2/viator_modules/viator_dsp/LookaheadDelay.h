@@ -0,0 +1,59 @@
+#ifndef LookaheadDelay_h
+#define LookaheadDelay_h
+
+#include "../Common/Common.h"
+
+namespace viator_dsp
+{
+
+/**
+    Shared lookahead plumbing for the dynamics processors.
+
+    Holds a circular delay line for the audio path and a sliding-window maximum
+    for the detector path, both sized in prepare() so nothing is allocated on the
+    audio thread. The window maximum uses a monotonic queue, so the peak hold
+    costs amortised O(1) per sample regardless of the lookahead length.
+*/
+template <typename SampleType>
+class LookaheadDelay
+{
+public:
+
+    /** Constructor. */
+    LookaheadDelay();
+
+    /** Allocates the delay line and peak queues for up to maximumDelayInSamples. */
+    void prepare (const juce::dsp::ProcessSpec& spec, int maximumDelayInSamples);
+
+    /** Clears the delay line and the peak queues. */
+    void reset();
+
+    /** Sets the lookahead in samples, clamped to the prepared maximum. */
+    void setDelay (int newDelayInSamples);
+
+    /** Returns the current lookahead in samples, which is also the latency it adds. */
+    int getDelay() const noexcept { return delay; }
+
+    /** Delays one channel of audio in place by the current lookahead. */
+    void processDelay (int channel, SampleType* data, int numSamples) noexcept;
+
+    /** Replaces rectified detector samples with the maximum over the last delay + 1 samples. */
+    void processPeakHold (int channel, SampleType* data, int numSamples) noexcept;
+
+private:
+    juce::AudioBuffer<SampleType> delayBuffer;
+    std::vector<int> writePositions;
+
+    /** Per channel ring of (value, sample index) pairs, decreasing in value from front to back */
+    juce::AudioBuffer<SampleType> queueValues;
+    std::vector<std::vector<juce::int64>> queueIndices;
+    std::vector<int> queueFront, queueSize;
+    std::vector<juce::int64> sampleCounters;
+
+    int delay = 0;
+    int maximumDelay = 0;
+};
+
+} // namespace viator_dsp
+
+#endif /* LookaheadDelay_h */
@@ -19,6 +19,26 @@ void viator_dsp::MultiBandProcessor<SampleType>::prepare(const juce::dsp::Proces
     _highBandsFilter.prepare(spec);
     _highBandsFilter.setCutoffFrequency(5000.0);
     
+    _numChannels = spec.numChannels;
+    _maximumBlockSize = spec.maximumBlockSize;
+    
+    // Every band gets its own set of channels; the two interleaved rows hold what's left and the band being split off
+    const auto numGroups = (_numChannels + lanes - 1) / lanes;
+    _bands = juce::dsp::AudioBlock<SampleType>(_bandData, maxBands * _numChannels, _maximumBlockSize);
+    _interleaved = juce::dsp::AudioBlock<SIMD>(_interleavedData, 2, _maximumBlockSize);
+    _crossoverStates.resize(numGroups * maxCrossovers);
+    _allpassStates.resize(numGroups * maxBands * maxCrossovers);
+    
+    // Settings first, so prepare() designs the filters they need
+    _linearPhase.setNumBands(_numBands);
+    
+    for (int index = 0; index < maxCrossovers; ++index)
+        _linearPhase.setCrossoverFrequency(index, _crossoverFrequencies[(size_t) index]);
+    
+    _linearPhase.prepare(spec);
+    
+    setSampleRate(spec.sampleRate);
+    
     reset();
 }
 
@@ -27,6 +47,227 @@ void viator_dsp::MultiBandProcessor<SampleType>::reset() noexcept
 {
     if (_currentSampleRate > 0)
     {
+        std::fill(_crossoverStates.begin(), _crossoverStates.end(), CrossoverState());
+        std::fill(_allpassStates.begin(), _allpassStates.end(), AllpassState());
+        _linearPhase.reset();
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::setCrossoverMode(CrossoverMode newMode)
+{
+    if (_crossoverMode != newMode)
+    {
+        _crossoverMode = newMode;
+        reset();
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::setPartitionSize(int newPartitionSize)
+{
+    _linearPhase.setPartitionSize(newPartitionSize);
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::setNumBands(int newNumBands)
+{
+    jassert(newNumBands >= 2 && newNumBands <= maxBands);
+    
+    _numBands = juce::jlimit(2, maxBands, newNumBands);
+    _linearPhase.setNumBands(_numBands);
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::setCrossoverFrequency(int index, SampleType newFrequency)
+{
+    jassert(index >= 0 && index < maxCrossovers);
+    
+    _crossoverFrequencies[(size_t) index] = newFrequency;
+    updateCrossover(index);
+    _linearPhase.setCrossoverFrequency(index, newFrequency);
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::setSampleRate(double newSampleRate)
+{
+    jassert(newSampleRate > 0);
+    
+    _currentSampleRate = static_cast<float>(newSampleRate);
+    
+    for (int index = 0; index < maxCrossovers; ++index)
+        updateCrossover(index);
+    
+    _linearPhase.setSampleRate(newSampleRate);
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::updateCrossover(int index) noexcept
+{
+    // Kept below Nyquist so the prewarp stays finite
+    const auto frequency = juce::jlimit(static_cast<SampleType>(10.0),
+                                        static_cast<SampleType>(_currentSampleRate * 0.49),
+                                        _crossoverFrequencies[(size_t) index]);
+    const auto g = static_cast<SampleType>(std::tan(juce::MathConstants<double>::pi * frequency / _currentSampleRate));
+    
+    _g[(size_t) index] = g;
+    _h[(size_t) index] = static_cast<SampleType>(1.0) / (static_cast<SampleType>(1.0) + juce::MathConstants<SampleType>::sqrt2 * g + g * g);
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::process(const juce::dsp::AudioBlock<const SampleType>& input) noexcept
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numSamples = input.getNumSamples();
+    
+    jassert(numChannels <= _numChannels);
+    jassert(numSamples <= _maximumBlockSize);
+    
+    _numProcessedChannels = numChannels;
+    _numProcessedSamples = numSamples;
+    
+    if (_crossoverMode == CrossoverMode::kLinearPhase)
+    {
+        std::array<juce::dsp::AudioBlock<SampleType>, maxBands> bands;
+        
+        for (int band = 0; band < _numBands; ++band)
+            bands[(size_t) band] = getBand(band);
+        
+        _linearPhase.process(input, bands.data());
+        return;
+    }
+    
+    auto* remaining = _interleaved.getChannelPointer(0);
+    auto* band = _interleaved.getChannelPointer(1);
+    
+    for (size_t group = 0; group * lanes < numChannels; ++group)
+    {
+        const auto firstChannel = group * lanes;
+        
+        interleave(input, firstChannel, remaining, numSamples);
+        
+        for (int crossover = 0; crossover < _numBands - 1; ++crossover)
+        {
+            splitBand(crossover, _crossoverStates[group * maxCrossovers + (size_t) crossover], remaining, band, numSamples);
+            
+            // Line this band up in phase with everything split off after it
+            for (int later = crossover + 1; later < _numBands - 1; ++later)
+            {
+                auto& state = _allpassStates[(group * maxBands + (size_t) crossover) * maxCrossovers + (size_t) later];
+                applyAllpass(later, state, band, numSamples);
+            }
+            
+            deinterleave(band, crossover, firstChannel, numSamples);
+        }
+        
+        deinterleave(remaining, _numBands - 1, firstChannel, numSamples);
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::splitBand(int crossover, CrossoverState& state, SIMD* remaining, SIMD* band, size_t numSamples) noexcept
+{
+    const auto g = SIMD::expand(_g[(size_t) crossover]);
+    const auto h = SIMD::expand(_h[(size_t) crossover]);
+    const auto damping = SIMD::expand(juce::MathConstants<SampleType>::sqrt2) + g;
+    
+    // Locals so the recursions stay in registers
+    auto s1 = state.s1, s2 = state.s2;
+    auto low1 = state.low1, low2 = state.low2;
+    auto high1 = state.high1, high2 = state.high2;
+    
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto yH = (remaining[i] - damping * s1 - s2) * h;
+        const auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        const auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+        
+        // Second Butterworth stage on each output makes them LR4
+        const auto lowH = (yL - damping * low1 - low2) * h;
+        const auto lowB = g * lowH + low1;
+        low1 = g * lowH + lowB;
+        const auto lowL = g * lowB + low2;
+        low2 = g * lowB + lowL;
+        
+        const auto highH = (yH - damping * high1 - high2) * h;
+        const auto highB = g * highH + high1;
+        high1 = g * highH + highB;
+        const auto highL = g * highB + high2;
+        high2 = g * highB + highL;
+        
+        band[i] = lowL;
+        remaining[i] = highH;
+    }
+    
+    state.s1 = s1; state.s2 = s2;
+    state.low1 = low1; state.low2 = low2;
+    state.high1 = high1; state.high2 = high2;
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::applyAllpass(int crossover, AllpassState& state, SIMD* band, size_t numSamples) noexcept
+{
+    const auto g = SIMD::expand(_g[(size_t) crossover]);
+    const auto h = SIMD::expand(_h[(size_t) crossover]);
+    const auto r2 = SIMD::expand(juce::MathConstants<SampleType>::sqrt2);
+    const auto damping = r2 + g;
+    
+    auto s1 = state.s1, s2 = state.s2;
+    
+    // LP4 + HP4 of an LR4 crossover is this second order allpass
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto yH = (band[i] - damping * s1 - s2) * h;
+        const auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        const auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+        
+        band[i] = yL - r2 * yB + yH;
+    }
+    
+    state.s1 = s1; state.s2 = s2;
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::interleave(const juce::dsp::AudioBlock<const SampleType>& input, size_t firstChannel, SIMD* destination, size_t numSamples) noexcept
+{
+    auto* samples = reinterpret_cast<SampleType*>(destination);
+    
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        const auto channel = firstChannel + lane;
+        
+        // Lanes past the last channel run on silence
+        if (channel < input.getNumChannels())
+        {
+            const auto* source = input.getChannelPointer(channel);
+            
+            for (size_t i = 0; i < numSamples; ++i)
+                samples[i * lanes + lane] = source[i];
+        }
+        else
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                samples[i * lanes + lane] = static_cast<SampleType>(0.0);
+        }
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::MultiBandProcessor<SampleType>::deinterleave(const SIMD* source, int band, size_t firstChannel, size_t numSamples) noexcept
+{
+    const auto* samples = reinterpret_cast<const SampleType*>(source);
+    const auto numLanes = juce::jmin(lanes, _numProcessedChannels - firstChannel);
+    
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        auto* destination = _bands.getChannelPointer((size_t) band * _numChannels + firstChannel + lane);
+        
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = samples[i * lanes + lane];
     }
 }
 
@@ -1,18 +1,81 @@
 #ifndef MultiBandProcessor_h
 #define MultiBandProcessor_h
 #include "../Common/Common.h"
+#include "LinearPhaseCrossover.h"
 
 namespace viator_dsp
 {
+/**
+    Linkwitz-Riley (LR4) band splitter.
+
+    processSample() is the original fixed four band, per sample splitter.
+
+    process() splits a whole block into 2 to maxBands bands, each written to a
+    preallocated band buffer that getBand() returns. The crossovers run as a
+    tree: every stage takes the low band off what's left. Each band then goes
+    through the allpass of every crossover split off after it, so all bands
+    share the same phase and simply adding them back gives a flat magnitude
+    response. The crossover and allpass recursions run on SIMDRegister with one
+    channel per lane, so a stereo pair costs the same as a mono channel.
+
+    In kLinearPhase mode process() hands the split to a LinearPhaseCrossover
+    instead, which trades latency for bands with no phase shift at all.
+*/
 template <typename SampleType>
 class MultiBandProcessor
 {
 public:
     
     MultiBandProcessor();
+    
+    /** Allocates the band buffers for spec.numChannels and spec.maximumBlockSize, so call it off the audio thread. */
     void prepare(const juce::dsp::ProcessSpec& spec) noexcept;
     void reset() noexcept;
     
+    /** The most bands process() can split into */
+    static constexpr int maxBands = 8;
+    
+    enum class CrossoverMode
+    {
+        kMinimumPhase,
+        kLinearPhase
+    };
+    
+    /** Switching clears the filter state of the mode being switched to. */
+    void setCrossoverMode(CrossoverMode newMode);
+    CrossoverMode getCrossoverMode() const noexcept { return _crossoverMode; }
+    
+    /** The linear-phase convolution's partition size; see LinearPhaseCrossover::setPartitionSize(). */
+    void setPartitionSize(int newPartitionSize);
+    
+    /** What process() delays every band by: 0 for the LR4 tree, the convolution's latency in kLinearPhase mode */
+    int getLatencySamples() const noexcept
+    {
+        return _crossoverMode == CrossoverMode::kLinearPhase ? _linearPhase.getLatencySamples() : 0;
+    }
+    
+    /** Sets how many bands process() splits into, between 2 and maxBands. */
+    void setNumBands(int newNumBands);
+    int getNumBands() const noexcept { return _numBands; }
+    
+    /** Sets the crossover between band index and index + 1, in Hz. */
+    void setCrossoverFrequency(int index, SampleType newFrequency);
+    
+    /** Retunes the crossovers for a new rate, e.g. when an oversampling factor changes. Doesn't allocate; the linear-phase filters are redesigned over the blocks that follow. */
+    void setSampleRate(double newSampleRate);
+    
+    /** Splits input into getNumBands() bands. input may have at most the prepared channels and block size. */
+    void process(const juce::dsp::AudioBlock<const SampleType>& input) noexcept;
+    
+    /** One band of the last process() call, lowest first. Valid until process() is called again. */
+    juce::dsp::AudioBlock<SampleType> getBand(int band) noexcept
+    {
+        jassert(band >= 0 && band < _numBands);
+        
+        return _bands.getSubsetChannelBlock((size_t) band * _numChannels, _numProcessedChannels)
+                     .getSubBlock(0, _numProcessedSamples);
+    }
+    
     void processSample(SampleType input, int ch)
     {
         _lowBandsFilter.processSample(ch, input, _lowBand, _lowMidBand);
@@ -70,6 +133,53 @@ private:
     juce::dsp::LinkwitzRileyFilter<float> _lowBandsFilter;
     juce::dsp::LinkwitzRileyFilter<float> _midBandsFilter;
     juce::dsp::LinkwitzRileyFilter<float> _highBandsFilter;
+    
+    //==============================================================================
+    using SIMD = juce::dsp::SIMDRegister<SampleType>;
+    
+    static constexpr int maxCrossovers = maxBands - 1;
+    
+    /** Shared first stage, then the second low and high pass stages, each a TPT state variable filter. */
+    struct CrossoverState
+    {
+        SIMD s1 {}, s2 {}, low1 {}, low2 {}, high1 {}, high2 {};
+    };
+    
+    struct AllpassState
+    {
+        SIMD s1 {}, s2 {};
+    };
+    
+    /** Splits remaining into band (low) and remaining (high) in place. */
+    void splitBand(int crossover, CrossoverState& state, SIMD* remaining, SIMD* band, size_t numSamples) noexcept;
+    void applyAllpass(int crossover, AllpassState& state, SIMD* band, size_t numSamples) noexcept;
+    
+    void interleave(const juce::dsp::AudioBlock<const SampleType>& input, size_t firstChannel, SIMD* destination, size_t numSamples) noexcept;
+    void deinterleave(const SIMD* source, int band, size_t firstChannel, size_t numSamples) noexcept;
+    
+    void updateCrossover(int index) noexcept;
+    
+    juce::HeapBlock<char> _bandData, _interleavedData;
+    juce::dsp::AudioBlock<SampleType> _bands;
+    juce::dsp::AudioBlock<SIMD> _interleaved;
+    
+    /** [group][crossover] and [group][band][crossover], one group per SIMD register of channels */
+    std::vector<CrossoverState> _crossoverStates;
+    std::vector<AllpassState> _allpassStates;
+    
+    std::array<SampleType, maxCrossovers> _crossoverFrequencies {80, 250, 800, 2500, 5000, 9000, 14000};
+    std::array<SampleType, maxCrossovers> _g {}, _h {};
+    
+    LinearPhaseCrossover<SampleType> _linearPhase;
+    CrossoverMode _crossoverMode = CrossoverMode::kMinimumPhase;
+    
+    int _numBands = 4;
+    size_t _numChannels = 0;
+    size_t _maximumBlockSize = 0;
+    size_t _numProcessedChannels = 0;
+    size_t _numProcessedSamples = 0;
+    
+    static constexpr auto lanes = SIMD::size();
 };
 }
 #endif
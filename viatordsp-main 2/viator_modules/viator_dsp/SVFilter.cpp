@@ -19,12 +19,138 @@ void viator_dsp::SVFilter<SampleType>::prepare(const juce::dsp::ProcessSpec& spe
     _output.reset(mCurrentSampleRate, 0.02);
     _output.setTargetValue(0.0);
     
-    mZ1.assign(spec.numChannels, 0.0);
-    mZ2.assign(spec.numChannels, 0.0);
+    // z1 and z2 are the rows, so each is one aligned run of channels
+    mState = juce::dsp::AudioBlock<StateType>(mStateData, 2, spec.numChannels);
+    mState.clear();
+    
+    mModulation = juce::dsp::AudioBlock<double>(mModulationData, 2, spec.maximumBlockSize);
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilter<SampleType>::reset()
+{
+    mState.clear();
+}
+
+template <typename SampleType>
+template <typename viator_dsp::SVFilter<SampleType>::FilterType type, bool modulated>
+void viator_dsp::SVFilter<SampleType>::processChannel(const SampleType* input, SampleType* output, size_t numSamples, size_t channel, juce::SmoothedValue<float> outputGain) noexcept
+{
+    auto coefficients = getCoefficients();
+    auto z1 = mState.getChannelPointer(0)[channel];
+    auto z2 = mState.getChannelPointer(1)[channel];
+    
+    if (outputGain.isSmoothing())
+    {
+        for (size_t sample = 0; sample < numSamples; ++sample)
+        {
+            if constexpr (modulated) applyModulation(coefficients, sample);
+            
+            const auto y = tick<type>(input[sample], z1, z2, coefficients);
+            output[sample] = static_cast<SampleType>(y) * juce::Decibels::decibelsToGain(outputGain.getNextValue());
+        }
+    }
+    
+    else
+    {
+        const auto gain = toState(juce::Decibels::decibelsToGain(outputGain.getTargetValue()));
+        
+        for (size_t sample = 0; sample < numSamples; ++sample)
+        {
+            if constexpr (modulated) applyModulation(coefficients, sample);
+            
+            output[sample] = static_cast<SampleType>(tick<type>(input[sample], z1, z2, coefficients) * gain);
+        }
+    }
+    
+    mState.getChannelPointer(0)[channel] = z1;
+    mState.getChannelPointer(1)[channel] = z2;
+}
+
+template <typename SampleType>
+template <typename viator_dsp::SVFilter<SampleType>::FilterType type, bool modulated>
+void viator_dsp::SVFilter<SampleType>::processMidSide(const SampleType* left, const SampleType* right, SampleType* leftOutput, SampleType* rightOutput, size_t numSamples) noexcept
+{
+    auto coefficients = getCoefficients();
+    const auto filterSides = mStereoType == StereoId::kSides;
+    const auto stateChannel = filterSides ? 1 : 0;
+    auto z1 = mState.getChannelPointer(0)[stateChannel];
+    auto z2 = mState.getChannelPointer(1)[stateChannel];
+    
+    // Only the selected component goes through the filter and the output gain
+    auto processFrame = [&](size_t sample, StateType gain)
+    {
+        if constexpr (modulated) applyModulation(coefficients, sample);
+        
+        const StateType mid_x = 0.5 * (StateType(left[sample]) + StateType(right[sample]));
+        const StateType side_x = 0.5 * (StateType(left[sample]) - StateType(right[sample]));
+        
+        const auto filtered = tick<type>(filterSides ? side_x : mid_x, z1, z2, coefficients) * gain;
+        const auto mid = filterSides ? mid_x : filtered;
+        const auto side = filterSides ? filtered : side_x;
+        
+        leftOutput[sample] = static_cast<SampleType>(mid + side);
+        rightOutput[sample] = static_cast<SampleType>(mid - side);
+    };
+    
+    if (_output.isSmoothing())
+    {
+        for (size_t sample = 0; sample < numSamples; ++sample)
+        {
+            processFrame(sample, juce::Decibels::decibelsToGain(_output.getNextValue()));
+        }
+    }
+    
+    else
+    {
+        const StateType gain = juce::Decibels::decibelsToGain(_output.getTargetValue());
+        
+        for (size_t sample = 0; sample < numSamples; ++sample)
+        {
+            processFrame(sample, gain);
+        }
+    }
+    
+    mState.getChannelPointer(0)[stateChannel] = z1;
+    mState.getChannelPointer(1)[stateChannel] = z2;
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilter<SampleType>::fillModulation(const NumericType* cutoffs, size_t numSamples) noexcept
+{
+    auto* g = mModulation.getChannelPointer(0);
+    auto* inversion = mModulation.getChannelPointer(1);
+    const auto maxCutoff = mCurrentSampleRate * 0.49;
+    
+    for (size_t start = 0; start < numSamples; start += modulationInterval)
+    {
+        const auto length = juce::jmin(modulationInterval, numSamples - start);
+        
+        // Same prewarp as preWarp(), aimed at the last cutoff of the segment
+        mCutoff = static_cast<float>(juce::jlimit(1.0, maxCutoff, static_cast<double>(cutoffs[start + length - 1])));
+        const auto targetG = tanApprox(mCutoff * 6.28f * halfSampleDuration);
+        const auto targetInversion = 1.0 / (1.0 + mRCoeff2 * targetG + targetG * targetG);
+        
+        const auto gStep = (targetG - mGCoeff) / static_cast<double>(length);
+        const auto inversionStep = (targetInversion - mInversion) / static_cast<double>(length);
+        
+        for (size_t i = 1; i <= length; ++i)
+        {
+            g[start + i - 1] = mGCoeff + gStep * static_cast<double>(i);
+            inversion[start + i - 1] = mInversion + inversionStep * static_cast<double>(i);
+        }
+        
+        mGCoeff = targetG;
+        mInversion = targetInversion;
+    }
+    
+    // What preWarp() would have left behind at the final cutoff
+    wd = mCutoff * 6.28f;
+    wa = mGCoeff * sampleRate2X;
 }
 
 template <typename SampleType>
-void viator_dsp::SVFilter<SampleType>::setParameter(ParameterId parameter, SampleType parameterValue)
+void viator_dsp::SVFilter<SampleType>::setParameter(ParameterId parameter, NumericType parameterValue)
 {
     switch (parameter)
     {
@@ -32,7 +158,6 @@ void viator_dsp::SVFilter<SampleType>::setParameter(ParameterId parameter, Sampl
         case ParameterId::kType:
         {
             mType = (FilterType)parameterValue;
-            setType();
             break;
         }
             
@@ -127,7 +252,7 @@ void viator_dsp::SVFilter<SampleType>::setParameter(ParameterId parameter, Sampl
 }
 
 template <typename SampleType>
-void viator_dsp::SVFilter<SampleType>::setOutput(SampleType newOutput)
+void viator_dsp::SVFilter<SampleType>::setOutput(NumericType newOutput)
 {
     _output.setTargetValue(newOutput);
 }
@@ -144,20 +269,20 @@ void viator_dsp::SVFilter<SampleType>::setStereoType(StereoId newStereoID)
 }
 
 template <typename SampleType>
-void viator_dsp::SVFilter<SampleType>::setGain(SampleType value)
+void viator_dsp::SVFilter<SampleType>::setGain(NumericType value)
 {
     mGain = pow(10, value * 0.05) - 1.f;
     mRawGain = value;
 }
 
 template <typename SampleType>
-SampleType viator_dsp::SVFilter<SampleType>::getShelfQ(SampleType value) const
+typename viator_dsp::SVFilter<SampleType>::NumericType viator_dsp::SVFilter<SampleType>::getShelfQ(NumericType value) const
 {
     return viator_utils::utils::dbToGain(std::abs(value)) * 0.25f - 0.24f;
 }
 
 template <typename SampleType>
-SampleType viator_dsp::SVFilter<SampleType>::getPeakQ(SampleType value) const
+typename viator_dsp::SVFilter<SampleType>::NumericType viator_dsp::SVFilter<SampleType>::getPeakQ(NumericType value) const
 {
     return viator_utils::utils::dbToGain(std::abs(value)) * 0.1f;
 }
@@ -177,19 +302,6 @@ void viator_dsp::SVFilter<SampleType>::preWarp()
     mInversion = 1.0 / (1.0 + mRCoeff2 * mGCoeff + mGCoeff * mGCoeff);
 }
 
-template <typename SampleType>
-void viator_dsp::SVFilter<SampleType>::setType()
-{
-    switch (mType)
-    {
-        case kLowShelf: lsLevel = 1.0; break;
-        case kBandShelf: bsLevel = 1.0; break;
-        case kHighShelf: hsLevel = 1.0; break;
-        case kLowPass: lpLevel = 1.0; break;
-        case kHighPass: hpLevel = 1.0; break;
-    }
-}
-
 template <typename SampleType>
 void viator_dsp::SVFilter<SampleType>::setSampleRates()
 {
@@ -199,5 +311,5 @@ void viator_dsp::SVFilter<SampleType>::setSampleRates()
 
 template class viator_dsp::SVFilter<float>;
 template class viator_dsp::SVFilter<double>;
-//template class viator_dsp::SVFilter<juce::dsp::SIMDRegister<float>>;
+template class viator_dsp::SVFilter<juce::dsp::SIMDRegister<float>>;
 
@@ -3,24 +3,44 @@
 
 namespace viator_dsp
 {
+/**
+    Zavalishin's TPT state variable filter with shelf, pass and band outputs.
+
+    SampleType may be float, double or juce::dsp::SIMDRegister<float>. The
+    SIMD version filters every lane of a register at once, so 4 or 8
+    interleaved channels (or bands sharing one setting) cost the same as one.
+    Interleave them into an AudioBlock<SIMDRegister<float>> and prepare with
+    the number of registers as the channel count. Scalar filters keep their
+    state and coefficients in double; SIMD ones keep registers, aligned the
+    way AudioBlock aligns them.
+
+    process() resolves the filter type once per block and only computes the
+    outputs that type mixes in.
+*/
 template <typename SampleType>
 class SVFilter
 {
 public:
     
+    /** float for SIMDRegister<float>, otherwise SampleType */
+    using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+    
     /** Creates an uninitialised filter. Call prepare() before first use. */
     SVFilter();
     
     /** Initialises the filter. */
     void prepare(const juce::dsp::ProcessSpec& spec);
     
+    /** Clears the filter state without reallocating. */
+    void reset();
+    
     /** Processes the input and output buffers supplied in the processing context. */
     template <typename ProcessContext>
     void process (const ProcessContext& context) noexcept
     {
         if (mRawGain == 0.0)
         {
-            if (mType != kHighPass && mType != kLowPass)
+            if (mType != kHighPass && mType != kLowPass && mType != kBandPass)
             {
                 return;
             }
@@ -32,103 +52,57 @@ public:
         
         if (mGlobalBypass) return;
         
-        auto&& inBlock  = context.getInputBlock();
-        auto&& outBlock = context.getOutputBlock();
-
-        jassert (inBlock.getNumChannels() == outBlock.getNumChannels());
-        jassert (inBlock.getNumSamples() == outBlock.getNumSamples());
-
-        auto len         = inBlock.getNumSamples();
-        auto numChannels = inBlock.getNumChannels();
+        processBlock<false> (context);
+    }
+    
+    /**
+        Processes the context with the cutoff following cutoffs, one value in Hz per
+        sample of the block, shared by every channel. Use it for LFO or envelope
+        driven sweeps.
         
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            
-            auto *input = inBlock.getChannelPointer(channel);
-            auto* output = outBlock.getChannelPointer (channel);
-            
-            auto *leftInputData = inBlock.getChannelPointer(0);
-            auto *leftOutputData = outBlock.getChannelPointer(0);
-            
-            for (size_t sample = 0; sample < len; ++sample)
-            {
-                if (inBlock.getNumChannels() == 2)
-                {
-                        
-                    auto *rightInputData = inBlock.getChannelPointer(1);
-                    auto *rightOutputData = outBlock.getChannelPointer(1);
-                    auto mid_x = 0.5 * (leftInputData[sample] + rightInputData[sample]);
-                    auto side_x = 0.5 * (leftInputData[sample] - rightInputData[sample]);
-                        
-                    switch (mStereoType)
-                    {
-                        case StereoId::kStereo:
-                        {
-                            output[sample] = processSample(input[sample], channel);
-                            break;
-                        }
-                                
-                        case StereoId::kMids:
-                        {
-                            mid_x = processSample(mid_x, channel);
-                                
-                            auto newL = mid_x + side_x;
-                            auto newR = mid_x - side_x;
-                                
-                            leftOutputData[sample] = newL;
-                            rightOutputData[sample] = newR;
-                            break;
-                        }
-                                
-                        case StereoId::kSides:
-                        {
-                            side_x = processSample(side_x, channel);
-                                
-                            auto newL = mid_x + side_x;
-                            auto newR = mid_x - side_x;
-                                
-                            leftOutputData[sample] = newL;
-                            rightOutputData[sample] = newR;
-                            break;
-                        }
-                    }
-                }
-                    
-                else
-                {
-                    output[sample] = processSample(input[sample], channel);
-                }
-            }
-        }
+        g comes from a rational tan approximation once every modulationInterval
+        samples, and g and the inversion are interpolated linearly in between. The
+        filter is left at the last cutoff, as if setParameter(kCutoff) had been called.
+    */
+    template <typename ProcessContext>
+    void processModulated (const ProcessContext& context, const NumericType* cutoffs) noexcept
+    {
+        if (mGlobalBypass) return;
+        
+        const auto len = context.getInputBlock().getNumSamples();
+        jassert (len <= mModulation.getNumSamples());
+        
+        fillModulation (cutoffs, len);
+        
+        // A zero gain shelf passes the input straight through, but still follows the cutoff
+        if (mRawGain == 0.0 && mType != kHighPass && mType != kLowPass && mType != kBandPass) return;
+        
+        processBlock<true> (context);
     }
     
+    /** Cutoffs are resolved to coefficients once per this many samples in processModulated() */
+    static constexpr size_t modulationInterval = 8;
+    
     /** Process an individual sample */
-    SampleType processSample(SampleType input, SampleType ch) noexcept
+    SampleType processSample(SampleType input, int ch) noexcept
     {
+        auto& z1 = mState.getChannelPointer(0)[ch];
+        auto& z2 = mState.getChannelPointer(1)[ch];
+        StateType output;
         
+        switch (mType)
+        {
+            case kLowShelf: output = tick<kLowShelf>(input, z1, z2, getCoefficients()); break;
+            case kHighPass: output = tick<kHighPass>(input, z1, z2, getCoefficients()); break;
+            case kBandShelf: output = tick<kBandShelf>(input, z1, z2, getCoefficients()); break;
+            case kLowPass: output = tick<kLowPass>(input, z1, z2, getCoefficients()); break;
+            case kHighShelf: output = tick<kHighShelf>(input, z1, z2, getCoefficients()); break;
+            case kBandPass: output = tick<kBandPass>(input, z1, z2, getCoefficients()); break;
+        }
         
-        const auto z1 = mZ1[ch];
-        const auto z2 = mZ2[ch];
-                                
-        const double HP = (input - mRCoeff2 * z1 - mGCoeff * z1 - z2) * mInversion;
-        const double BP = HP * mGCoeff + z1;
-        const double LP = BP * mGCoeff + z2;
-        const double UBP = mRCoeff2 * BP;
-        const double BShelf = input + UBP * mGain;
-        const double LS = input + mGain * LP;
-        const double HS = input + mGain * HP;
-                    
-        //Main output code
-        input = BShelf * bsLevel + LS * lsLevel + HS * hsLevel + HP * hpLevel + LP * lpLevel;
-                   
-        // unit delay (state variable)
-        mZ1[ch] = mGCoeff * HP + BP;
-        mZ2[ch] = mGCoeff * BP + LP;
-
-        return input * juce::Decibels::decibelsToGain(_output.getNextValue());
+        return static_cast<SampleType>(output) * juce::Decibels::decibelsToGain(_output.getNextValue());
     }
     
-    
     /** The parameters of this module. */
     enum class ParameterId
     {
@@ -148,7 +122,8 @@ public:
         kHighPass,
         kBandShelf,
         kLowPass,
-        kHighShelf
+        kHighShelf,
+        kBandPass
     };
     
     /** Different filter Q-Factor types*/
@@ -166,12 +141,153 @@ public:
     };
     
     /** One method to change any parameter. */
-    void setParameter(ParameterId parameter, SampleType parameterValue);
-    void setOutput(SampleType newOutput);
+    void setParameter(ParameterId parameter, NumericType parameterValue);
+    void setOutput(NumericType newOutput);
     void setStereoType(StereoId newStereoType);
     
 private:
     
+    static constexpr bool isSIMD = !std::is_same<SampleType, NumericType>::value;
+    
+    /** double for the scalar filters, as before; the register itself for SIMD */
+    using StateType = std::conditional_t<isSIMD, SampleType, double>;
+    
+    /** The coefficients one block or sample needs, spread across the lanes for SIMD */
+    struct Coefficients
+    {
+        StateType g, damping, inversion, bandGain, gain;
+    };
+    
+    Coefficients getCoefficients() const noexcept
+    {
+        return {toState(mGCoeff), toState(mRCoeff2 + mGCoeff), toState(mInversion), toState(mRCoeff2), toState(mGain)};
+    }
+    
+    /** Swaps in sample's interpolated g and inversion from fillModulation() */
+    void applyModulation(Coefficients& coefficients, size_t sample) const noexcept
+    {
+        const auto g = mModulation.getChannelPointer(0)[sample];
+        coefficients.g = toState(g);
+        coefficients.damping = toState(mRCoeff2 + g);
+        coefficients.inversion = toState(mModulation.getChannelPointer(1)[sample]);
+    }
+    
+    void fillModulation(const NumericType* cutoffs, size_t numSamples) noexcept;
+    
+    /**
+        tan(x) for 0 <= x < pi/2, as a [5/4] Pade approximant on [0, pi/4] and its
+        reciprocal reflected about pi/4 above that. The relative error stays under
+        1.5e-8 up to 0.49 of the sample rate.
+    */
+    static double tanApprox(double x) noexcept
+    {
+        constexpr auto quarterPi = juce::MathConstants<double>::pi * 0.25;
+        constexpr auto halfPi = juce::MathConstants<double>::halfPi;
+        
+        const auto reflect = x > quarterPi;
+        const auto y = reflect ? halfPi - x : x;
+        const auto y2 = y * y;
+        const auto numerator = y * (945.0 - 105.0 * y2 + y2 * y2);
+        const auto denominator = 945.0 - 420.0 * y2 + 15.0 * y2 * y2;
+        
+        return reflect ? denominator / numerator : numerator / denominator;
+    }
+    
+    static StateType toState(double value) noexcept
+    {
+        if constexpr (isSIMD)
+            return SampleType::expand(static_cast<NumericType>(value));
+        else
+            return value;
+    }
+    
+    /** One sample of the filter, computing only what type's output needs */
+    template <FilterType type>
+    static StateType tick(StateType input, StateType& z1, StateType& z2, const Coefficients& c) noexcept
+    {
+        const auto hp = (input - c.damping * z1 - z2) * c.inversion;
+        const auto bp = hp * c.g + z1;
+        const auto lp = bp * c.g + z2;
+        
+        // unit delay (state variable)
+        z1 = c.g * hp + bp;
+        z2 = c.g * bp + lp;
+        
+        if constexpr (type == kLowShelf) return input + lp * c.gain;
+        else if constexpr (type == kHighPass) return hp;
+        else if constexpr (type == kBandShelf) return input + bp * c.bandGain * c.gain;
+        else if constexpr (type == kLowPass) return lp;
+        else if constexpr (type == kHighShelf) return input + hp * c.gain;
+        else return bp * c.bandGain;
+    }
+    
+    template <bool modulated, typename ProcessContext>
+    void processBlock (const ProcessContext& context) noexcept
+    {
+        auto&& inBlock  = context.getInputBlock();
+        auto&& outBlock = context.getOutputBlock();
+
+        jassert (inBlock.getNumChannels() == outBlock.getNumChannels());
+        jassert (inBlock.getNumSamples() == outBlock.getNumSamples());
+
+        auto len         = inBlock.getNumSamples();
+        auto numChannels = inBlock.getNumChannels();
+        
+        // SIMD lanes are channels already, so mid/side only applies to a scalar stereo pair
+        if constexpr (!isSIMD)
+        {
+            if (numChannels == 2 && mStereoType != StereoId::kStereo)
+            {
+                const auto* left = inBlock.getChannelPointer (0);
+                const auto* right = inBlock.getChannelPointer (1);
+                auto* leftOutput = outBlock.getChannelPointer (0);
+                auto* rightOutput = outBlock.getChannelPointer (1);
+                
+                switch (mType)
+                {
+                    case kLowShelf: processMidSide<kLowShelf, modulated> (left, right, leftOutput, rightOutput, len); break;
+                    case kHighPass: processMidSide<kHighPass, modulated> (left, right, leftOutput, rightOutput, len); break;
+                    case kBandShelf: processMidSide<kBandShelf, modulated> (left, right, leftOutput, rightOutput, len); break;
+                    case kLowPass: processMidSide<kLowPass, modulated> (left, right, leftOutput, rightOutput, len); break;
+                    case kHighShelf: processMidSide<kHighShelf, modulated> (left, right, leftOutput, rightOutput, len); break;
+                    case kBandPass: processMidSide<kBandPass, modulated> (left, right, leftOutput, rightOutput, len); break;
+                }
+                
+                return;
+            }
+        }
+        
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* input = inBlock.getChannelPointer (channel);
+            auto* output = outBlock.getChannelPointer (channel);
+            
+            // Every channel gets its own copy of the output ramp
+            switch (mType)
+            {
+                case kLowShelf: processChannel<kLowShelf, modulated> (input, output, len, channel, _output); break;
+                case kHighPass: processChannel<kHighPass, modulated> (input, output, len, channel, _output); break;
+                case kBandShelf: processChannel<kBandShelf, modulated> (input, output, len, channel, _output); break;
+                case kLowPass: processChannel<kLowPass, modulated> (input, output, len, channel, _output); break;
+                case kHighShelf: processChannel<kHighShelf, modulated> (input, output, len, channel, _output); break;
+                case kBandPass: processChannel<kBandPass, modulated> (input, output, len, channel, _output); break;
+            }
+        }
+        
+        _output.skip (static_cast<int> (len));
+    }
+    
+    
+    template <FilterType type, bool modulated>
+    void processChannel(const SampleType* input, SampleType* output, size_t numSamples, size_t channel, juce::SmoothedValue<float> outputGain) noexcept;
+    
+    /**
+        Encodes each stereo frame once, filters the selected component and decodes
+        it again. The mid path uses channel 0's state and the side path channel 1's.
+    */
+    template <FilterType type, bool modulated>
+    void processMidSide(const SampleType* left, const SampleType* right, SampleType* leftOutput, SampleType* rightOutput, size_t numSamples) noexcept;
+    
     /** Member variables */
     float mCurrentSampleRate, mQ, mCutoff, mGain, mRawGain, twoPi;
     bool mGlobalBypass;
@@ -188,21 +304,20 @@ private:
     /** Stereo Type*/
     StereoId mStereoType;
     
-     /** state variables (z^-1) */
-    std::vector<double> mZ1, mZ2;
+     /** state variables (z^-1): row 0 is z1 and row 1 is z2, one column per channel */
+    juce::HeapBlock<char> mStateData;
+    juce::dsp::AudioBlock<StateType> mState;
+    
+    /** Per sample g and inversion for processModulated(): rows 0 and 1, maximum block size long */
+    juce::HeapBlock<char> mModulationData;
+    juce::dsp::AudioBlock<double> mModulation;
     
     /** Convert the gain if needed */
-    void setGain(SampleType value);
+    void setGain(NumericType value);
     
     /** Get the different Q-Fators*/
-    SampleType getShelfQ(SampleType value) const;
-    SampleType getPeakQ(SampleType value) const;
-    
-    float lsLevel = 0.0;
-    float bsLevel = 0.0;
-    float hsLevel = 0.0;
-    float lpLevel = 0.0;
-    float hpLevel = 0.0;
+    NumericType getShelfQ(NumericType value) const;
+    NumericType getPeakQ(NumericType value) const;
     
     juce::SmoothedValue<float> _output;
     
@@ -213,7 +328,6 @@ private:
     double wa;
     
     void preWarp();
-    void setType();
     void setSampleRates();
 };
 }
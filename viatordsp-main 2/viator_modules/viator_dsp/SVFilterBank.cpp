@@ -0,0 +1,252 @@
+#include "SVFilterBank.h"
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    numChannels = spec.numChannels;
+
+    const auto numGroups = (numChannels + registerSize - 1) / registerSize;
+    interleaved = juce::dsp::AudioBlock<Register>(interleavedData, numGroups, spec.maximumBlockSize);
+    state = juce::dsp::AudioBlock<Register>(stateData, numGroups, 2 * maxBands);
+
+    for (int index = 0; index < maxBands; ++index)
+    {
+        updateCoefficients(index);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::reset()
+{
+    interleaved.clear();
+    state.clear();
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::setBand(int index, FilterType type, SampleType cutoff, SampleType q, SampleType gain)
+{
+    jassert(juce::isPositiveAndBelow(index, maxBands));
+
+    types[index] = type;
+    cutoffs[index] = cutoff;
+    qs[index] = q;
+    gains[index] = gain;
+
+    updateCoefficients(index);
+    updateActiveBands();
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::setBandEnabled(int index, bool shouldBeEnabled)
+{
+    jassert(juce::isPositiveAndBelow(index, maxBands));
+
+    enabled[index] = shouldBeEnabled;
+    updateActiveBands();
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::updateCoefficients(int index) noexcept
+{
+    // The same prewarp and damping as SVFilter's parametric Q
+    const auto r2 = 2.0 * (1.0 - static_cast<double>(qs[index]));
+    const auto bandG = std::tan(static_cast<float>(cutoffs[index]) * 6.28f * 0.5 / sampleRate);
+    const auto gain = std::pow(10.0, static_cast<double>(gains[index]) * 0.05) - 1.0;
+
+    g[index] = static_cast<SampleType>(bandG);
+    damping[index] = static_cast<SampleType>(r2 + bandG);
+    inversion[index] = static_cast<SampleType>(1.0 / (1.0 + r2 * bandG + bandG * bandG));
+
+    double input = 0.0, high = 0.0, band = 0.0, low = 0.0;
+
+    switch (types[index])
+    {
+        case FilterType::kLowShelf: input = 1.0; low = gain; break;
+        case FilterType::kHighPass: high = 1.0; break;
+        case FilterType::kBandShelf: input = 1.0; band = r2 * gain; break;
+        case FilterType::kLowPass: low = 1.0; break;
+        case FilterType::kHighShelf: input = 1.0; high = gain; break;
+        case FilterType::kBandPass: band = r2; break;
+    }
+
+    inputMix[index] = static_cast<SampleType>(input);
+    highMix[index] = static_cast<SampleType>(high);
+    bandMix[index] = static_cast<SampleType>(band);
+    lowMix[index] = static_cast<SampleType>(low);
+}
+
+template <typename SampleType>
+bool viator_dsp::SVFilterBank<SampleType>::isBandRunning(int index) const noexcept
+{
+    if (!enabled[index]) return false;
+
+    switch (types[index])
+    {
+        case FilterType::kHighPass: return cutoffs[index] != 20.0;
+        case FilterType::kLowPass: return cutoffs[index] != 20000.0;
+        case FilterType::kBandPass: return true;
+        default: return gains[index] != 0.0;
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::updateActiveBands() noexcept
+{
+    std::array<bool, maxBands> wasRunning {};
+
+    for (int k = 0; k < numActiveBands; ++k)
+    {
+        wasRunning[activeBands[k]] = true;
+    }
+
+    numActiveBands = 0;
+
+    for (int index = 0; index < maxBands; ++index)
+    {
+        if (!isBandRunning(index)) continue;
+
+        // Anything left from when the band last ran would click
+        if (!wasRunning[index])
+        {
+            for (size_t group = 0; group < state.getNumChannels(); ++group)
+            {
+                state.getChannelPointer(group)[index] = Register();
+                state.getChannelPointer(group)[maxBands + index] = Register();
+            }
+        }
+
+        activeBands[numActiveBands++] = index;
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t group) noexcept
+{
+    auto* destination = reinterpret_cast<SampleType*>(interleaved.getChannelPointer(group));
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t lane = 0; lane < registerSize; ++lane)
+    {
+        const auto channel = group * registerSize + lane;
+
+        if (channel < block.getNumChannels())
+        {
+            const auto* source = block.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                destination[i * registerSize + lane] = source[i];
+            }
+        }
+
+        else
+        {
+            // Spare lanes run silence so they can't build up denormals
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                destination[i * registerSize + lane] = 0;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::deinterleave(const juce::dsp::AudioBlock<SampleType>& block, size_t group) noexcept
+{
+    const auto* source = reinterpret_cast<const SampleType*>(interleaved.getChannelPointer(group));
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t lane = 0; lane < registerSize; ++lane)
+    {
+        const auto channel = group * registerSize + lane;
+
+        if (channel >= block.getNumChannels()) break;
+
+        auto* destination = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            destination[i] = source[i * registerSize + lane];
+        }
+    }
+}
+
+template <typename SampleType>
+void viator_dsp::SVFilterBank<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    if (numActiveBands == 0 || context.isBypassed) return;
+
+    const auto& block = context.getOutputBlock();
+    const auto numSamples = block.getNumSamples();
+
+    jassert(block.getNumChannels() <= numChannels);
+    jassert(numSamples <= interleaved.getNumSamples());
+
+    // The active bands' coefficients, packed and spread across the lanes once per block
+    Register bandG[maxBands], bandDamping[maxBands], bandInversion[maxBands];
+    Register bandInput[maxBands], bandHigh[maxBands], bandBand[maxBands], bandLow[maxBands];
+    Register z1[maxBands], z2[maxBands];
+
+    for (int k = 0; k < numActiveBands; ++k)
+    {
+        const auto index = activeBands[k];
+        bandG[k] = Register::expand(g[index]);
+        bandDamping[k] = Register::expand(damping[index]);
+        bandInversion[k] = Register::expand(inversion[index]);
+        bandInput[k] = Register::expand(inputMix[index]);
+        bandHigh[k] = Register::expand(highMix[index]);
+        bandBand[k] = Register::expand(bandMix[index]);
+        bandLow[k] = Register::expand(lowMix[index]);
+    }
+
+    const auto numGroups = (block.getNumChannels() + registerSize - 1) / registerSize;
+
+    for (size_t group = 0; group < numGroups; ++group)
+    {
+        interleave(block, group);
+
+        auto* groupState = state.getChannelPointer(group);
+        auto* data = interleaved.getChannelPointer(group);
+
+        for (int k = 0; k < numActiveBands; ++k)
+        {
+            z1[k] = groupState[activeBands[k]];
+            z2[k] = groupState[maxBands + activeBands[k]];
+        }
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = data[i];
+
+            // The bands are in series, so each one waits on the last
+            for (int k = 0; k < numActiveBands; ++k)
+            {
+                const auto hp = (x - bandDamping[k] * z1[k] - z2[k]) * bandInversion[k];
+                const auto bp = hp * bandG[k] + z1[k];
+                const auto lp = bp * bandG[k] + z2[k];
+
+                // unit delay (state variable)
+                z1[k] = bandG[k] * hp + bp;
+                z2[k] = bandG[k] * bp + lp;
+
+                x = x * bandInput[k] + hp * bandHigh[k] + bp * bandBand[k] + lp * bandLow[k];
+            }
+
+            data[i] = x;
+        }
+
+        for (int k = 0; k < numActiveBands; ++k)
+        {
+            groupState[activeBands[k]] = z1[k];
+            groupState[maxBands + activeBands[k]] = z2[k];
+        }
+
+        deinterleave(block, group);
+    }
+}
+
+template class viator_dsp::SVFilterBank<float>;
+template class viator_dsp::SVFilterBank<double>;
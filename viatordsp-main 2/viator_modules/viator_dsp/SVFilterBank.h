@@ -0,0 +1,88 @@
+#ifndef SVFilterBank_h
+#define SVFilterBank_h
+
+#include "../Common/Common.h"
+#include "SVFilter.h"
+
+namespace viator_dsp
+{
+/**
+    Up to maxBands SVFilter bands in series, run in one pass over the block.
+
+    Channels are interleaved into SIMDRegisters, so each register holds 4 or 8
+    channels (2 or 4 for double). Every sample frame then goes through all the
+    active bands before the next one is read. Each band's coefficients and
+    state sit in arrays indexed by band, so an 8 band EQ's working set is a few
+    hundred bytes. Each band's output is a mix of the input and its high, band
+    and low pass outputs, so the per-sample loop doesn't branch on band type.
+
+    Bands are skipped for the whole block when disabled, or when
+    SVFilter::process() would bypass them: a shelf at 0 dB, a high pass at
+    20 Hz or a low pass at 20 kHz. Q is SVFilter's parametric Q.
+*/
+template <typename SampleType>
+class SVFilterBank
+{
+public:
+
+    using FilterType = typename SVFilter<SampleType>::FilterType;
+
+    static constexpr int maxBands = 16;
+
+    /** Initialises the bank. Allocates, so call it off the audio thread. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    /** Clears every band's state. */
+    void reset();
+
+    /** Sets band index's type, cutoff in Hz, parametric Q and gain in dB. Doesn't allocate. */
+    void setBand(int index, FilterType type, SampleType cutoff, SampleType q, SampleType gain);
+
+    /** Bands start disabled. A band that starts running again starts from silence. */
+    void setBandEnabled(int index, bool enabled);
+
+    /** The bands process() runs at the moment */
+    int getNumActiveBands() const noexcept { return numActiveBands; }
+
+    /** Runs every active band over the block, in band order. */
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr size_t registerSize = Register::SIMDNumElements;
+
+    void updateCoefficients(int index) noexcept;
+    void updateActiveBands() noexcept;
+    bool isBandRunning(int index) const noexcept;
+    void interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t group) noexcept;
+    void deinterleave(const juce::dsp::AudioBlock<SampleType>& block, size_t group) noexcept;
+
+    /** Per band settings */
+    std::array<FilterType, maxBands> types {};
+    std::array<SampleType, maxBands> cutoffs {}, qs {}, gains {};
+    std::array<bool, maxBands> enabled {};
+
+    /** Per band coefficients: the filter, then the output mix of input, high, band and low pass */
+    std::array<SampleType, maxBands> g {}, damping {}, inversion {};
+    std::array<SampleType, maxBands> inputMix {}, highMix {}, bandMix {}, lowMix {};
+
+    /** The bands process() runs, in order */
+    std::array<int, maxBands> activeBands {};
+    int numActiveBands = 0;
+
+    /** One row of registers per group of registerSize channels */
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<Register> interleaved;
+
+    /** One row per channel group: every band's z1, then every band's z2 */
+    juce::HeapBlock<char> stateData;
+    juce::dsp::AudioBlock<Register> state;
+
+    double sampleRate = 44100.0;
+    size_t numChannels = 0;
+};
+}
+
+#endif /* SVFilterBank_h */
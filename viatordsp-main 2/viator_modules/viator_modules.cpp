@@ -12,12 +12,19 @@
 /** Viator DSP CPP Files*/
 #include "viator_dsp/Distortion.cpp"
 #include "viator_dsp/SVFilter.cpp"
+#include "viator_dsp/SVFilterBank.cpp"
+#include "viator_dsp/DynamicEQ.cpp"
 #include "viator_dsp/LFOGenerator.cpp"
+#include "viator_dsp/LinearPhaseCrossover.cpp"
 #include "viator_dsp/MultiBandProcessor.cpp"
 #include "viator_dsp/BitCrusher.cpp"
 #include "viator_dsp/BrickWallLPF.cpp"
 #include "viator_dsp/Expander.cpp"
 #include "viator_dsp/Tube.cpp"
+#include "viator_dsp/LookaheadDelay.cpp"
+#include "viator_dsp/LevelAnalyser.cpp"
+#include "viator_dsp/Compressor.cpp"
+#include "viator_dsp/DynamicsProcessor.cpp"
 
 /** Viator GUI CPP Files*/
 #include "viator_gui/Widgets/Dial.cpp"
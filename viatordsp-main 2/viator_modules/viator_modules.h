@@ -22,12 +22,19 @@
 /** Viator DSP Headers*/
 #include "viator_dsp/Distortion.h"
 #include "viator_dsp/SVFilter.h"
+#include "viator_dsp/SVFilterBank.h"
+#include "viator_dsp/DynamicEQ.h"
 #include "viator_dsp/LFOGenerator.h"
+#include "viator_dsp/LinearPhaseCrossover.h"
 #include "viator_dsp/MultiBandProcessor.h"
 #include "viator_dsp/BitCrusher.h"
 #include "viator_dsp/BrickWallLPF.h"
 #include "viator_dsp/Expander.h"
 #include "viator_dsp/Tube.h"
+#include "viator_dsp/LookaheadDelay.h"
+#include "viator_dsp/LevelAnalyser.h"
+#include "viator_dsp/Compressor.h"
+#include "viator_dsp/DynamicsProcessor.h"
 
 /** Viator GUI Headers*/
 #include "viator_gui/Widgets/Dial.h"
@@ -162,6 +162,55 @@ namespace viator_utils
             
             return u.d;
         }
+
+        /** Fast log2 for positive inputs, absolute error below 2.2e-5 (about 1.3e-4 dB).
+            Branch-free so loops over contiguous buffers auto-vectorise.
+        */
+        static inline float fastLog2(float x) noexcept
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+
+            const auto exponent = static_cast<float>(static_cast<int32_t>((bits >> 23) & 0xffu) - 127);
+
+            // Mantissa in [1, 2), then atanh series: log2(m) = 2/ln2 * (t + t^3/3 + t^5/5 + t^7/7)
+            bits = (bits & 0x007fffffu) | 0x3f800000u;
+            float mantissa;
+            std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+            const auto t = (mantissa - 1.0f) / (mantissa + 1.0f);
+            const auto t2 = t * t;
+
+            return exponent + t * (2.8853900818f + t2 * (0.9617966939f + t2 * (0.5770780164f + t2 * 0.4121985831f)));
+        }
+
+        /** Fast 2^x, relative error below 6e-6. Input is clamped to [-126, 126].
+            Branch-free and free of libm calls, so loops over contiguous buffers auto-vectorise.
+        */
+        static inline float fastExp2(float x) noexcept
+        {
+            // Clamps |x| on the bit pattern. Float compares would stop GCC vectorising under its default -ftrapping-math
+            uint32_t inputBits;
+            std::memcpy(&inputBits, &x, sizeof(inputBits));
+
+            const auto magnitude = static_cast<int32_t>(inputBits & 0x7fffffffu);
+            constexpr int32_t limit = 0x42fc0000; // 126.0f
+            inputBits = (inputBits & 0x80000000u) | static_cast<uint32_t>(magnitude < limit ? magnitude : limit);
+            std::memcpy(&x, &inputBits, sizeof(x));
+
+            // Rounds to nearest: x + 126.5 is positive, so truncation is floor
+            const auto whole = static_cast<float>(static_cast<int32_t>(x + 126.5f) - 126);
+            const auto fraction = (x - whole) * 0.6931471806f;
+
+            // e^f for |f| <= ln2 / 2
+            const auto poly = 1.0f + fraction * (1.0f + fraction * (0.5f + fraction * (0.1666666667f + fraction * (0.0416666667f + fraction * 0.0083333333f))));
+
+            const auto bits = static_cast<uint32_t>(static_cast<int32_t>(whole) + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+
+            return poly * scale;
+        }
     };
 
 namespace gui_utils